@@ -0,0 +1,97 @@
+#include <StormByte/database/sqlite/backup.hxx>
+#include <StormByte/database/sqlite/exception.hxx>
+
+#include <sqlite3.h>
+
+using namespace StormByte::Database::SQLite;
+
+Backup::Backup(sqlite3* source, const std::filesystem::path& file, const int& pages_per_step, const std::chrono::milliseconds& interval, const std::chrono::milliseconds& step_pause):
+m_source(source), m_destination(nullptr), m_file(file), m_pages_per_step(pages_per_step > 0 ? pages_per_step : -1),
+m_interval(interval), m_step_pause(step_pause), m_stop(false) {
+	if (sqlite3_open(m_file.string().c_str(), &m_destination) != SQLITE_OK) {
+		std::string message = "Cannot open backup database " + m_file.string() + ": " + sqlite3_errmsg(m_destination);
+		sqlite3_close(m_destination);
+		throw ConnectionError(std::move(message));
+	}
+	m_worker = std::thread(&Backup::run, this);
+}
+
+Backup::~Backup() noexcept {
+	stop(false);
+	sqlite3_close(m_destination);
+}
+
+void Backup::stop(const bool& final_snapshot) noexcept {
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_stop = true;
+	}
+	m_cv.notify_all();
+	if (m_worker.joinable())
+		m_worker.join();
+	if (final_snapshot)
+		snapshot();
+}
+
+bool Backup::snapshot() {
+	std::lock_guard<std::mutex> snapshot_lock(m_snapshot_mutex);
+	const auto start = std::chrono::steady_clock::now();
+	sqlite3_backup* backup = sqlite3_backup_init(m_destination, "main", m_source, "main");
+	if (!backup) {
+		failed(sqlite3_errmsg(m_destination));
+		return false;
+	}
+
+	int rc;
+	unsigned int busy = 0;
+	do {
+		rc = sqlite3_backup_step(backup, m_pages_per_step);
+		busy = (rc == SQLITE_BUSY || rc == SQLITE_LOCKED) ? busy + 1 : 0;
+		if (rc == SQLITE_OK || (busy > 0 && busy <= BUSY_RETRIES)) {
+			// Writers get the source back between steps, when stopping the copy just runs to the end
+			const auto pause_start = std::chrono::steady_clock::now();
+			{
+				std::unique_lock<std::mutex> lock(m_mutex);
+				m_cv.wait_for(lock, m_step_pause, [this] { return m_stop; });
+			}
+			// but a locked source is still waited for, retrying at once would spin until the writer is done
+			const auto paused = std::chrono::steady_clock::now() - pause_start;
+			if (busy > 0 && paused < BUSY_PAUSE)
+				std::this_thread::sleep_for(BUSY_PAUSE - paused);
+		}
+	} while (rc == SQLITE_OK || (busy > 0 && busy <= BUSY_RETRIES));
+
+	const int pages = sqlite3_backup_pagecount(backup);
+	if (sqlite3_backup_finish(backup) != SQLITE_OK || rc != SQLITE_DONE) {
+		failed(busy > BUSY_RETRIES ? "Source database stayed locked for " + std::to_string(BUSY_RETRIES) + " backup steps" : sqlite3_errmsg(m_destination));
+		return false;
+	}
+
+	std::lock_guard<std::mutex> lock(m_mutex);
+	m_statistics.snapshots++;
+	m_statistics.pages = static_cast<uint64_t>(pages);
+	m_statistics.last_duration = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start);
+	return true;
+}
+
+BackupStatistics Backup::statistics() const {
+	std::lock_guard<std::mutex> lock(m_mutex);
+	return m_statistics;
+}
+
+void Backup::run() {
+	while (true) {
+		{
+			std::unique_lock<std::mutex> lock(m_mutex);
+			if (m_cv.wait_for(lock, m_interval, [this] { return m_stop; }))
+				break;
+		}
+		snapshot();
+	}
+}
+
+void Backup::failed(const std::string& error) {
+	std::lock_guard<std::mutex> lock(m_mutex);
+	m_statistics.failures++;
+	m_statistics.last_error = error;
+}
@@ -0,0 +1,62 @@
+#pragma once
+
+#ifdef STORMBYTE_ENABLE_SQLITE
+	#include <StormByte/visibility.h>
+
+	#include <chrono>
+	#include <condition_variable>
+	#include <cstdint>
+	#include <filesystem>
+	#include <mutex>
+	#include <string>
+	#include <thread>
+
+	class sqlite3;
+	namespace StormByte::Database::SQLite {
+		struct STORMBYTE_PUBLIC BackupStatistics {
+			uint64_t snapshots							= 0;	// Completed full copies
+			uint64_t failures							= 0;
+			uint64_t pages								= 0;	// Pages in the last completed copy
+			std::chrono::milliseconds last_duration		{ 0 };
+			std::string last_error;
+		};
+
+		/**
+		 * Periodically copies a live database into a file with sqlite3_backup_step,
+		 * a few pages per tick, so writers are never locked out for a whole copy.
+		 */
+		class STORMBYTE_PRIVATE Backup {
+			public:
+				// Consecutive busy or locked steps before a snapshot fails, each followed by at least the pause
+				static constexpr unsigned int BUSY_RETRIES = 200;
+				static constexpr std::chrono::milliseconds BUSY_PAUSE { 10 };
+
+				Backup(sqlite3*, const std::filesystem::path&, const int&, const std::chrono::milliseconds&, const std::chrono::milliseconds&);
+				Backup(const Backup&)				= delete;
+				Backup(Backup&&)					= delete;
+				Backup& operator=(const Backup&)	= delete;
+				Backup& operator=(Backup&&)			= delete;
+				~Backup() noexcept;
+
+				void stop(const bool&) noexcept;
+				bool snapshot();
+				BackupStatistics statistics() const;
+
+			private:
+				void run();
+				void failed(const std::string&);
+
+				sqlite3* m_source;
+				sqlite3* m_destination;
+				std::filesystem::path m_file;
+				int m_pages_per_step;
+				std::chrono::milliseconds m_interval, m_step_pause;
+				bool m_stop;
+				BackupStatistics m_statistics;
+				mutable std::mutex m_mutex;
+				std::mutex m_snapshot_mutex;
+				std::condition_variable m_cv;
+				std::thread m_worker;
+		};
+	}
+#endif
@@ -0,0 +1,234 @@
+#include <StormByte/database/sqlite/blob_stream.hxx>
+#include <StormByte/database/sqlite/exception.hxx>
+#include <StormByte/system/pipe.hxx>
+
+#include <algorithm>
+#include <cstring>
+#include <sqlite3.h>
+
+using namespace StormByte::Database::SQLite;
+
+BlobStream::BlobStream(sqlite3_blob* blob, const bool& writable, const size_t& chunk_size):
+std::iostream(nullptr), m_buffer(blob, writable, chunk_size) {
+	rdbuf(&m_buffer);
+}
+
+BlobStream::~BlobStream() noexcept {
+	m_buffer.pubsync();
+}
+
+size_t BlobStream::Size() const noexcept {
+	return m_buffer.size();
+}
+
+bool BlobStream::Writable() const noexcept {
+	return m_buffer.writable();
+}
+
+size_t BlobStream::Read(std::span<char> out, const size_t& offset) {
+	m_buffer.invalidate();
+	if (offset >= m_buffer.size())
+		return 0;
+
+	const size_t bytes = std::min(out.size(), m_buffer.size() - offset);
+	if (!m_buffer.read(out.data(), bytes, offset))
+		throw QueryError("Can not read " + std::to_string(bytes) + " bytes from blob at offset " + std::to_string(offset));
+	return bytes;
+}
+
+void BlobStream::Write(std::span<const char> in, const size_t& offset) {
+	m_buffer.invalidate();
+	if (!m_buffer.writable())
+		throw QueryError("Blob was not opened for writing");
+	if (offset + in.size() > m_buffer.size())
+		throw OutOfBounds(m_buffer.size(), offset + in.size());
+	if (!m_buffer.write(in.data(), in.size(), offset))
+		throw QueryError("Can not write " + std::to_string(in.size()) + " bytes to blob at offset " + std::to_string(offset));
+}
+
+void BlobStream::Reopen(const int64_t& rowid) {
+	m_buffer.reopen(rowid);
+	clear();
+}
+
+bool BlobStream::WriteTo(System::Pipe& pipe) {
+	m_buffer.invalidate();
+	std::vector<char> chunk(m_buffer.chunk_size());
+	size_t offset = 0;
+	while (offset < m_buffer.size()) {
+		const size_t bytes = Read(chunk, offset);
+		if (!pipe.write_all(chunk.data(), bytes))
+			return false;
+		offset += bytes;
+	}
+	return true;
+}
+
+BlobStream::Buffer::Buffer(sqlite3_blob* blob, const bool& writable, const size_t& chunk_size):
+m_blob(blob), m_writable(writable), m_size(static_cast<size_t>(sqlite3_blob_bytes(blob))), m_base(0),
+m_chunk(std::max<size_t>(chunk_size, 1)) {}
+
+BlobStream::Buffer::~Buffer() noexcept {
+	if (m_blob) {
+		sqlite3_blob_close(m_blob);
+		m_blob = nullptr;
+	}
+}
+
+size_t BlobStream::Buffer::size() const noexcept {
+	return m_size;
+}
+
+bool BlobStream::Buffer::writable() const noexcept {
+	return m_writable;
+}
+
+size_t BlobStream::Buffer::chunk_size() const noexcept {
+	return m_chunk.size();
+}
+
+bool BlobStream::Buffer::read(char* out, const size_t& bytes, const size_t& offset) {
+	return sqlite3_blob_read(m_blob, out, static_cast<int>(bytes), static_cast<int>(offset)) == SQLITE_OK;
+}
+
+bool BlobStream::Buffer::write(const char* in, const size_t& bytes, const size_t& offset) {
+	return sqlite3_blob_write(m_blob, in, static_cast<int>(bytes), static_cast<int>(offset)) == SQLITE_OK;
+}
+
+void BlobStream::Buffer::reopen(const int64_t& rowid) {
+	flush_put();
+	setg(nullptr, nullptr, nullptr);
+	m_base = 0;
+	const int rc = sqlite3_blob_reopen(m_blob, rowid);
+	if (rc != SQLITE_OK) {
+		m_size = 0;
+		throw QueryError("Can not reopen blob for row " + std::to_string(rowid) + ": " + sqlite3_errstr(rc));
+	}
+	m_size = static_cast<size_t>(sqlite3_blob_bytes(m_blob));
+}
+
+void BlobStream::Buffer::invalidate() {
+	flush_put();
+	m_base = position();
+	setg(nullptr, nullptr, nullptr);
+}
+
+BlobStream::Buffer::int_type BlobStream::Buffer::underflow() {
+	if (!flush_put())
+		return traits_type::eof();
+
+	const size_t pos = position();
+	if (pos >= m_size)
+		return traits_type::eof();
+
+	const size_t bytes = std::min(m_chunk.size(), m_size - pos);
+	if (!read(m_chunk.data(), bytes, pos))
+		return traits_type::eof();
+
+	m_base = pos;
+	setg(m_chunk.data(), m_chunk.data(), m_chunk.data() + bytes);
+	return traits_type::to_int_type(*gptr());
+}
+
+BlobStream::Buffer::int_type BlobStream::Buffer::overflow(int_type c) {
+	if (!m_writable || !flush_put())
+		return traits_type::eof();
+
+	const size_t pos = position();
+	setg(nullptr, nullptr, nullptr);
+	m_base = pos;
+	// Blobs can not grow so the put area is capped by the remaining space
+	const size_t room = std::min(m_chunk.size(), m_size - std::min(pos, m_size));
+	if (room == 0)
+		return traits_type::eof();
+
+	setp(m_chunk.data(), m_chunk.data() + room);
+	if (!traits_type::eq_int_type(c, traits_type::eof())) {
+		*pptr() = traits_type::to_char_type(c);
+		pbump(1);
+		return c;
+	}
+	return traits_type::not_eof(c);
+}
+
+std::streamsize BlobStream::Buffer::xsgetn(char_type* out, std::streamsize count) {
+	std::streamsize done = 0;
+	if (gptr() && gptr() < egptr()) {
+		done = std::min<std::streamsize>(count, egptr() - gptr());
+		std::memcpy(out, gptr(), static_cast<size_t>(done));
+		gbump(static_cast<int>(done));
+	}
+
+	// Large reads go straight to the destination instead of through the chunk
+	if (count - done >= static_cast<std::streamsize>(m_chunk.size())) {
+		if (!flush_put())
+			return done;
+		const size_t pos = position();
+		const size_t bytes = std::min(static_cast<size_t>(count - done), m_size - std::min(pos, m_size));
+		if (bytes > 0 && read(out + done, bytes, pos)) {
+			setg(nullptr, nullptr, nullptr);
+			m_base = pos + bytes;
+			done += static_cast<std::streamsize>(bytes);
+		}
+		return done;
+	}
+
+	return done + std::streambuf::xsgetn(out + done, count - done);
+}
+
+std::streamsize BlobStream::Buffer::showmanyc() {
+	const size_t pos = position();
+	return pos < m_size ? static_cast<std::streamsize>(m_size - pos) : -1;
+}
+
+int BlobStream::Buffer::sync() {
+	return flush_put() ? 0 : -1;
+}
+
+BlobStream::Buffer::pos_type BlobStream::Buffer::seekoff(off_type off, std::ios_base::seekdir dir, std::ios_base::openmode which) {
+	off_type base = 0;
+	switch (dir) {
+		case std::ios_base::beg:
+			base = 0;
+			break;
+
+		case std::ios_base::cur:
+			base = static_cast<off_type>(position());
+			break;
+
+		default:
+			base = static_cast<off_type>(m_size);
+			break;
+	}
+	return seekpos(pos_type(base + off), which);
+}
+
+BlobStream::Buffer::pos_type BlobStream::Buffer::seekpos(pos_type pos, std::ios_base::openmode) {
+	const off_type target = static_cast<off_type>(pos);
+	if (target < 0 || target > static_cast<off_type>(m_size) || !flush_put())
+		return pos_type(off_type(-1));
+
+	setg(nullptr, nullptr, nullptr);
+	m_base = static_cast<size_t>(target);
+	return pos;
+}
+
+size_t BlobStream::Buffer::position() const noexcept {
+	if (gptr())
+		return m_base + static_cast<size_t>(gptr() - eback());
+	else if (pptr())
+		return m_base + static_cast<size_t>(pptr() - pbase());
+	else
+		return m_base;
+}
+
+bool BlobStream::Buffer::flush_put() {
+	if (!pptr())
+		return true;
+
+	const size_t bytes = static_cast<size_t>(pptr() - pbase());
+	const bool ok = bytes == 0 || write(pbase(), bytes, m_base);
+	m_base += bytes;
+	setp(nullptr, nullptr);
+	return ok;
+}
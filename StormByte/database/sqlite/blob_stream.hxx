@@ -0,0 +1,78 @@
+#pragma once
+
+#ifdef STORMBYTE_ENABLE_SQLITE
+	#include <StormByte/visibility.h>
+
+	#include <cstdint>
+	#include <iostream>
+	#include <span>
+	#include <streambuf>
+	#include <vector>
+
+	class sqlite3_blob;
+	namespace StormByte::System { class Pipe; }
+	namespace StormByte::Database::SQLite {
+		/**
+		 * Incremental I/O over a single BLOB cell which never holds more than one
+		 * chunk in memory. The blob size is fixed at open time (use zeroblob(N) on
+		 * INSERT/UPDATE to reserve space before writing).
+		 */
+		class STORMBYTE_PUBLIC BlobStream: public std::iostream {
+			friend class SQLite3;
+			public:
+				static constexpr size_t DEFAULT_CHUNK_SIZE	= 64 * 1024; // 64KiB
+
+				BlobStream(const BlobStream&)				= delete;
+				BlobStream(BlobStream&&)					= delete;
+				BlobStream& operator=(const BlobStream&)	= delete;
+				BlobStream& operator=(BlobStream&&)			= delete;
+				~BlobStream() noexcept override;
+
+				size_t 					Size() const noexcept;
+				bool 					Writable() const noexcept;
+				size_t 					Read(std::span<char>, const size_t&);
+				void 					Write(std::span<const char>, const size_t&);
+				void 					Reopen(const int64_t&);
+				bool 					WriteTo(System::Pipe&);
+
+			private:
+				class Buffer: public std::streambuf {
+					public:
+						Buffer(sqlite3_blob*, const bool&, const size_t&);
+						Buffer(const Buffer&)				= delete;
+						Buffer& operator=(const Buffer&)	= delete;
+						~Buffer() noexcept override;
+
+						size_t size() const noexcept;
+						bool writable() const noexcept;
+						size_t chunk_size() const noexcept;
+						bool read(char*, const size_t&, const size_t&);
+						bool write(const char*, const size_t&, const size_t&);
+						void reopen(const int64_t&);
+						void invalidate();
+
+					protected:
+						int_type underflow() override;
+						int_type overflow(int_type) override;
+						std::streamsize xsgetn(char_type*, std::streamsize) override;
+						std::streamsize showmanyc() override;
+						int sync() override;
+						pos_type seekoff(off_type, std::ios_base::seekdir, std::ios_base::openmode) override;
+						pos_type seekpos(pos_type, std::ios_base::openmode) override;
+
+					private:
+						size_t position() const noexcept;
+						bool flush_put();
+
+						sqlite3_blob* m_blob;
+						bool m_writable;
+						size_t m_size, m_base;
+						std::vector<char> m_chunk;
+				};
+
+				BlobStream(sqlite3_blob*, const bool&, const size_t&);
+
+				Buffer m_buffer;
+		};
+	}
+#endif
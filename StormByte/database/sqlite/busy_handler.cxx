@@ -0,0 +1,119 @@
+#include <StormByte/database/sqlite/busy_handler.hxx>
+#include <StormByte/database/sqlite/deadline.hxx>
+
+#include <algorithm>
+#include <random>
+
+using namespace StormByte::Database::SQLite;
+
+BusyHandler::BusyHandler() noexcept:m_enabled(false), m_waits(0), m_retries(0), m_timeouts(0), m_blocked_us(0),
+m_deadlines(0), m_cancelled(false) {}
+
+void BusyHandler::SetPolicy(const BusyPolicy& policy) {
+	std::lock_guard<std::mutex> lock(m_mutex);
+	m_policy = policy;
+	m_enabled = true;
+}
+
+BusyPolicy BusyHandler::GetPolicy() const {
+	std::lock_guard<std::mutex> lock(m_mutex);
+	return m_policy;
+}
+
+bool BusyHandler::IsEnabled() const noexcept {
+	return m_enabled;
+}
+
+BusyStatistics BusyHandler::Statistics() const noexcept {
+	BusyStatistics stats;
+	stats.waits		= m_waits;
+	stats.retries	= m_retries;
+	stats.timeouts	= m_timeouts;
+	stats.blocked	= std::chrono::microseconds(m_blocked_us);
+	return stats;
+}
+
+void BusyHandler::ResetStatistics() noexcept {
+	m_waits = 0;
+	m_retries = 0;
+	m_timeouts = 0;
+	m_blocked_us = 0;
+}
+
+bool BusyHandler::Retry(const unsigned int& attempt) {
+	if (!m_enabled)
+		return false;
+
+	const BusyPolicy policy = GetPolicy();
+	if (attempt >= policy.retries || m_cancelled)
+		return false;
+
+	m_retries++;
+	return sleep(backoff(policy, attempt));
+}
+
+int BusyHandler::Callback(void* data, int count) {
+	BusyHandler* handler = static_cast<BusyHandler*>(data);
+	const BusyPolicy policy = handler->GetPolicy();
+	const auto now = std::chrono::steady_clock::now();
+	// SQLite calls the handler holding the connection mutex so the start mark is not contended
+	if (count == 0)
+		handler->m_wait_start = now;
+
+	const auto elapsed = std::chrono::duration_cast<std::chrono::microseconds>(now - handler->m_wait_start);
+	if (elapsed >= policy.timeout) {
+		handler->m_timeouts++;
+		return 0;
+	}
+
+	const auto remaining = std::chrono::duration_cast<std::chrono::microseconds>(policy.timeout) - elapsed;
+	if (handler->m_cancelled)
+		return 0;
+	handler->m_waits++;
+	// Zero makes the statement fail with SQLITE_BUSY, which is reported as the deadline or the cancellation
+	return handler->sleep(std::min(handler->backoff(policy, static_cast<unsigned int>(count)), remaining)) ? 1 : 0;
+}
+
+std::chrono::microseconds BusyHandler::backoff(const BusyPolicy& policy, const unsigned int& attempt) const {
+	thread_local std::minstd_rand generator { std::random_device{}() };
+	const auto base = std::max<std::chrono::microseconds::rep>(policy.initial_backoff.count(), 1);
+	const auto cap = std::max<std::chrono::microseconds::rep>(policy.max_backoff.count(), base);
+	const auto delay = std::min(cap, base << std::min(attempt, 20u));
+	// Jitter in [delay/2, delay] keeps competing writers from waking in lockstep
+	std::uniform_int_distribution<std::chrono::microseconds::rep> jitter(delay / 2, delay);
+	return std::chrono::microseconds(jitter(generator));
+}
+
+bool BusyHandler::sleep(std::chrono::microseconds time) {
+	const auto start = std::chrono::steady_clock::now();
+	const std::chrono::steady_clock::time_point deadline = Deadline::Current(this);
+	if (start >= deadline)
+		return false;
+	time = std::min(time, std::chrono::duration_cast<std::chrono::microseconds>(deadline - start));
+
+	bool cancelled;
+	{
+		// Woken early by cancel()
+		std::unique_lock<std::mutex> lock(m_wake_mutex);
+		cancelled = m_wake.wait_for(lock, time, [this] { return m_cancelled.load(); });
+	}
+	const auto end = std::chrono::steady_clock::now();
+	m_blocked_us += static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::microseconds>(end - start).count());
+	return !cancelled && end < deadline;
+}
+
+void BusyHandler::cancel() noexcept {
+	{
+		std::lock_guard<std::mutex> lock(m_wake_mutex);
+		m_cancelled = true;
+	}
+	m_wake.notify_all();
+}
+
+void BusyHandler::uncancel() noexcept {
+	m_cancelled = false;
+}
+
+bool BusyHandler::cancelled() const noexcept {
+	return m_cancelled;
+}
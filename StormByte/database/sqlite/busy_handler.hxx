@@ -0,0 +1,75 @@
+#pragma once
+
+#ifdef STORMBYTE_ENABLE_SQLITE
+	#include <StormByte/visibility.h>
+
+	#include <atomic>
+	#include <chrono>
+	#include <condition_variable>
+	#include <cstddef>
+	#include <cstdint>
+	#include <mutex>
+
+	namespace StormByte::Database::SQLite {
+		struct STORMBYTE_PUBLIC BusyPolicy {
+			std::chrono::milliseconds timeout			{ 5000 };	// Maximum wait inside the busy handler for a single lock
+			std::chrono::microseconds initial_backoff	{ 500 };	// Doubles on every wait up to max_backoff
+			std::chrono::microseconds max_backoff		{ 100000 };
+			unsigned int retries						= 3;		// Statement retries once the handler gave up (autocommit only)
+		};
+
+		struct STORMBYTE_PUBLIC BusyStatistics {
+			uint64_t waits								= 0;		// Busy handler sleeps
+			uint64_t retries							= 0;		// Statement level retries
+			uint64_t timeouts							= 0;		// Times the busy handler gave up
+			std::chrono::microseconds blocked			{ 0 };		// Total time spent sleeping on locks
+		};
+
+		/**
+		 * Waits never outlast the deadline of the thread waiting (see Deadline) and
+		 * end as soon as it is cancelled: the progress handler enforcing both does not
+		 * run while SQLite sleeps here.
+		 */
+		class STORMBYTE_PUBLIC BusyHandler {
+			friend class Deadline;
+			friend class PreparedSTMT;
+			friend class SQLite3;
+			public:
+				BusyHandler() noexcept;
+				BusyHandler(const BusyHandler&)				= delete;
+				BusyHandler(BusyHandler&&)					= delete;
+				BusyHandler& operator=(const BusyHandler&)	= delete;
+				BusyHandler& operator=(BusyHandler&&)		= delete;
+				~BusyHandler() noexcept						= default;
+
+				void 				SetPolicy(const BusyPolicy&);
+				BusyPolicy			GetPolicy() const;
+				bool 				IsEnabled() const noexcept;
+				BusyStatistics		Statistics() const noexcept;
+				void 				ResetStatistics() noexcept;
+
+				// Sleeps before statement retry number attempt, returns false when retries are exhausted
+				bool 				Retry(const unsigned int&);
+				static int 			Callback(void*, int);
+
+			private:
+				std::chrono::microseconds backoff(const BusyPolicy&, const unsigned int&) const;
+				// Capped at the deadline, false when it passed or the statement was cancelled
+				bool sleep(std::chrono::microseconds);
+				void cancel() noexcept;
+				void uncancel() noexcept;
+				bool cancelled() const noexcept;
+
+				mutable std::mutex m_mutex;
+				BusyPolicy m_policy;
+				std::atomic<bool> m_enabled;
+				std::chrono::steady_clock::time_point m_wait_start;
+				std::atomic<uint64_t> m_waits, m_retries, m_timeouts, m_blocked_us;
+				std::mutex m_deadline_mutex;
+				size_t m_deadlines; // Live on the connection, from any thread
+				std::atomic<bool> m_cancelled;
+				std::mutex m_wake_mutex;
+				std::condition_variable m_wake;
+		};
+	}
+#endif
@@ -0,0 +1,103 @@
+#include <StormByte/database/sqlite/change_feed.hxx>
+
+#include <algorithm>
+
+using namespace StormByte::Database::SQLite;
+
+ChangeFeed::ChangeFeed(const size_t& capacity, const bool& values, const std::vector<std::string>& tables):
+m_capacity(capacity > 0 ? capacity : 1), m_values(values), m_tables(tables.begin(), tables.end()),
+m_dropped(0), m_overflowed(false), m_closed(false) {}
+
+std::vector<Change> ChangeFeed::Drain(const size_t& max, const std::chrono::milliseconds& wait) {
+	std::vector<Change> changes;
+	std::unique_lock<std::mutex> lock(m_mutex);
+	if (wait.count() > 0)
+		m_cv.wait_for(lock, wait, [this] { return !m_queue.empty() || m_closed; });
+
+	const size_t count = (max == 0) ? m_queue.size() : std::min(max, m_queue.size());
+	changes.reserve(count);
+	for (size_t i = 0; i < count; i++) {
+		changes.push_back(std::move(m_queue.front()));
+		m_queue.pop_front();
+	}
+	return changes;
+}
+
+size_t ChangeFeed::Size() const noexcept {
+	std::lock_guard<std::mutex> lock(m_mutex);
+	return m_queue.size();
+}
+
+uint64_t ChangeFeed::Dropped() const noexcept {
+	std::lock_guard<std::mutex> lock(m_mutex);
+	return m_dropped;
+}
+
+bool ChangeFeed::Overflowed(const bool& clear) noexcept {
+	std::lock_guard<std::mutex> lock(m_mutex);
+	const bool overflowed = m_overflowed;
+	if (clear)
+		m_overflowed = false;
+	return overflowed;
+}
+
+bool ChangeFeed::CapturesValues() const noexcept {
+	return m_values;
+}
+
+void ChangeFeed::Close() noexcept {
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_closed = true;
+	}
+	m_cv.notify_all();
+}
+
+bool ChangeFeed::IsClosed() const noexcept {
+	std::lock_guard<std::mutex> lock(m_mutex);
+	return m_closed;
+}
+
+bool ChangeFeed::watches(const char* table) const {
+	return m_tables.empty() || m_tables.find(table) != m_tables.end();
+}
+
+void ChangeFeed::record(Change&& change) {
+	std::lock_guard<std::mutex> lock(m_mutex);
+	m_pending.push_back(std::move(change));
+}
+
+void ChangeFeed::committed() {
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		if (m_pending.empty())
+			return;
+
+		for (auto& change: m_pending) {
+			if (m_queue.size() < m_capacity)
+				m_queue.push_back(std::move(change));
+			else {
+				m_dropped++;
+				m_overflowed = true;
+			}
+		}
+		m_pending.clear();
+	}
+	m_cv.notify_all();
+}
+
+void ChangeFeed::rolled_back() noexcept {
+	std::lock_guard<std::mutex> lock(m_mutex);
+	m_pending.clear();
+}
+
+size_t ChangeFeed::mark() const noexcept {
+	std::lock_guard<std::mutex> lock(m_mutex);
+	return m_pending.size();
+}
+
+void ChangeFeed::rollback_to(const size_t& mark) noexcept {
+	std::lock_guard<std::mutex> lock(m_mutex);
+	if (mark < m_pending.size())
+		m_pending.erase(m_pending.begin() + static_cast<std::ptrdiff_t>(mark), m_pending.end());
+}
@@ -0,0 +1,73 @@
+#pragma once
+
+#ifdef STORMBYTE_ENABLE_SQLITE
+	#include <StormByte/database/sqlite/result.hxx>
+
+	#include <chrono>
+	#include <condition_variable>
+	#include <cstdint>
+	#include <deque>
+	#include <mutex>
+	#include <optional>
+	#include <string>
+	#include <unordered_set>
+	#include <vector>
+
+	namespace StormByte::Database::SQLite {
+		struct STORMBYTE_PUBLIC Change {
+			enum class Operation: unsigned short { Insert = 0, Update, Delete };
+
+			Operation operation;
+			std::string database;
+			std::string table;
+			int64_t rowid;								// Row before the change (inserted row for inserts)
+			int64_t new_rowid;							// Differs from rowid only if an update changed it
+			std::optional<std::vector<Result>> old_values;	// Only with preupdate hook support
+			std::optional<std::vector<Result>> new_values;
+		};
+
+		/**
+		 * Bounded queue of committed row changes. Changes are held back until their
+		 * transaction commits and discarded if it rolls back. When the queue is full
+		 * new changes are dropped and Overflowed() tells consumers to resync.
+		 */
+		class STORMBYTE_PUBLIC ChangeFeed {
+			friend class CommitTracker;
+			friend class SQLite3;
+			public:
+				ChangeFeed(const size_t&, const bool&, const std::vector<std::string>& = {});
+				ChangeFeed(const ChangeFeed&)				= delete;
+				ChangeFeed(ChangeFeed&&)					= delete;
+				ChangeFeed& operator=(const ChangeFeed&)	= delete;
+				ChangeFeed& operator=(ChangeFeed&&)			= delete;
+				~ChangeFeed() noexcept						= default;
+
+				// Waits up to the given time for a change and takes at most max of them (0 for all)
+				std::vector<Change> 	Drain(const size_t& = 0, const std::chrono::milliseconds& = std::chrono::milliseconds(0));
+				size_t 					Size() const noexcept;
+				uint64_t 				Dropped() const noexcept;
+				bool 					Overflowed(const bool& = true) noexcept; // Optionally clears the flag
+				bool 					CapturesValues() const noexcept;
+				void 					Close() noexcept;
+				bool 					IsClosed() const noexcept;
+
+			private:
+				bool watches(const char*) const;
+				void record(Change&&);
+				void committed();
+				void rolled_back() noexcept;
+				size_t mark() const noexcept;
+				void rollback_to(const size_t&) noexcept;
+
+				size_t m_capacity;
+				bool m_values;
+				std::unordered_set<std::string> m_tables;
+				std::vector<Change> m_pending;	// Changes of the open transaction
+				std::deque<Change> m_queue;
+				uint64_t m_dropped;
+				bool m_overflowed, m_closed;
+				mutable std::mutex m_mutex;
+				std::condition_variable m_cv;
+		};
+	}
+#endif
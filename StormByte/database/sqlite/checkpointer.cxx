@@ -0,0 +1,67 @@
+#include <StormByte/database/sqlite/checkpointer.hxx>
+#include <StormByte/database/sqlite/exception.hxx>
+
+#include <algorithm>
+#include <sqlite3.h>
+
+using namespace StormByte::Database::SQLite;
+
+Checkpointer::Checkpointer(const std::filesystem::path& file, const std::chrono::milliseconds& interval, const size_t& wal_limit):
+m_database(nullptr), m_wal(file.string() + "-wal"), m_interval(interval),
+m_poll(std::clamp(interval, std::chrono::milliseconds(10), std::chrono::milliseconds(250))), m_wal_limit(wal_limit), m_stop(false) {
+	if (sqlite3_open_v2(file.string().c_str(), &m_database, SQLITE_OPEN_READWRITE, nullptr) != SQLITE_OK) {
+		std::string message = "Cannot open database " + file.string() + " for checkpointing: " + sqlite3_errmsg(m_database);
+		sqlite3_close_v2(m_database);
+		throw ConnectionError(std::move(message));
+	}
+	// TRUNCATE waits this long for readers before falling back to PASSIVE
+	sqlite3_busy_timeout(m_database, 100);
+	// A connection only opens the WAL once it reads the database, until then checkpoints do nothing
+	sqlite3_exec(m_database, "SELECT 1 FROM sqlite_schema LIMIT 1", nullptr, nullptr, nullptr);
+	m_checkpointer = std::thread(&Checkpointer::run, this);
+}
+
+Checkpointer::~Checkpointer() noexcept {
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_stop = true;
+	}
+	m_cv.notify_all();
+	if (m_checkpointer.joinable())
+		m_checkpointer.join();
+	sqlite3_close_v2(m_database);
+}
+
+void Checkpointer::run() {
+	auto last = std::chrono::steady_clock::now();
+	std::unique_lock<std::mutex> lock(m_mutex);
+	while (!m_cv.wait_for(lock, m_poll, [this] { return m_stop; })) {
+		lock.unlock();
+		const size_t size = wal_size();
+		const auto now = std::chrono::steady_clock::now();
+		if (m_wal_limit > 0 && size >= m_wal_limit) {
+			// Copying without blocking writers first keeps the truncation itself short
+			checkpoint(SQLITE_CHECKPOINT_PASSIVE);
+			checkpoint(SQLITE_CHECKPOINT_TRUNCATE);
+			last = now;
+		}
+		else if (size > 0 && now - last >= m_interval) {
+			checkpoint(SQLITE_CHECKPOINT_PASSIVE);
+			last = now;
+		}
+		lock.lock();
+	}
+}
+
+size_t Checkpointer::wal_size() const noexcept {
+	std::error_code error;
+	const auto size = std::filesystem::file_size(m_wal, error);
+	return error ? 0 : static_cast<size_t>(size);
+}
+
+void Checkpointer::checkpoint(const int& mode) noexcept {
+	const int rc = sqlite3_wal_checkpoint_v2(m_database, nullptr, mode, nullptr, nullptr);
+	// Readers kept the WAL busy: copy what can be copied and retry the truncation on the next poll
+	if (rc == SQLITE_BUSY && mode != SQLITE_CHECKPOINT_PASSIVE)
+		sqlite3_wal_checkpoint_v2(m_database, nullptr, SQLITE_CHECKPOINT_PASSIVE, nullptr, nullptr);
+}
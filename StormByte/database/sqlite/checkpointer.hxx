@@ -0,0 +1,44 @@
+#pragma once
+
+#ifdef STORMBYTE_ENABLE_SQLITE
+	#include <StormByte/visibility.h>
+
+	#include <chrono>
+	#include <condition_variable>
+	#include <filesystem>
+	#include <mutex>
+	#include <thread>
+
+	class sqlite3;
+	namespace StormByte::Database::SQLite {
+		/**
+		 * Checkpoints a WAL database from a background thread with its own
+		 * connection, so commits never pay for it. A PASSIVE checkpoint runs once
+		 * the interval elapses and a TRUNCATE one as soon as the WAL file reaches
+		 * the size limit, which also shrinks the file back.
+		 */
+		class STORMBYTE_PRIVATE Checkpointer {
+			public:
+				Checkpointer(const std::filesystem::path&, const std::chrono::milliseconds&, const size_t&);
+				Checkpointer(const Checkpointer&)				= delete;
+				Checkpointer(Checkpointer&&)					= delete;
+				Checkpointer& operator=(const Checkpointer&)	= delete;
+				Checkpointer& operator=(Checkpointer&&)			= delete;
+				~Checkpointer() noexcept;
+
+			private:
+				void run();
+				size_t wal_size() const noexcept;
+				void checkpoint(const int&) noexcept;
+
+				sqlite3* m_database;
+				std::filesystem::path m_wal;
+				std::chrono::milliseconds m_interval, m_poll;
+				size_t m_wal_limit;
+				bool m_stop;
+				std::mutex m_mutex;
+				std::condition_variable m_cv;
+				std::thread m_checkpointer;
+		};
+	}
+#endif
@@ -0,0 +1,205 @@
+#include <StormByte/database/sqlite/column.hxx>
+#include <StormByte/database/sqlite/exception.hxx>
+
+#include <cstdio>
+#include <cstdlib>
+#include <sqlite3.h>
+
+using namespace StormByte::Database::SQLite;
+
+Column::Column(std::string&& name):m_name(std::move(name)), m_type(Type::Null), m_size(0), m_reserved(0) {}
+
+const std::string& Column::Name() const noexcept {
+	return m_name;
+}
+
+const Type& Column::GetType() const noexcept {
+	return m_type;
+}
+
+size_t Column::Size() const noexcept {
+	return m_size;
+}
+
+bool Column::IsNull(const size_t& row) const {
+	if (row >= m_size)
+		throw OutOfBounds(m_size, row);
+
+	return (m_validity[row / 64] & (uint64_t(1) << (row % 64))) == 0;
+}
+
+const std::vector<int64_t>& Column::Integers() const {
+	if (m_type != Type::Integer)
+		throw WrongResultType(m_type, Type::Integer);
+
+	return m_integers;
+}
+
+const std::vector<double>& Column::Doubles() const {
+	if (m_type != Type::Double)
+		throw WrongResultType(m_type, Type::Double);
+
+	return m_doubles;
+}
+
+const std::vector<size_t>& Column::Offsets() const {
+	if (m_type != Type::String)
+		throw WrongResultType(m_type, Type::String);
+
+	return m_offsets;
+}
+
+const std::string& Column::Bytes() const {
+	if (m_type != Type::String)
+		throw WrongResultType(m_type, Type::String);
+
+	return m_bytes;
+}
+
+std::string_view Column::Text(const size_t& row) const {
+	if (m_type != Type::String)
+		throw WrongResultType(m_type, Type::String);
+	if (row >= m_size)
+		throw OutOfBounds(m_size, row);
+
+	return std::string_view(m_bytes.data() + m_offsets[row], m_offsets[row + 1] - m_offsets[row]);
+}
+
+const std::vector<uint64_t>& Column::Validity() const noexcept {
+	return m_validity;
+}
+
+void Column::append(sqlite3_stmt* stmt, const int& index) {
+	const int type = sqlite3_column_type(stmt, index);
+	if (type == SQLITE_NULL) {
+		append_null();
+		return;
+	}
+
+	if (m_type == Type::Null)
+		set_type(type == SQLITE_INTEGER ? Type::Integer : type == SQLITE_FLOAT ? Type::Double : Type::String);
+	else if (m_type == Type::Integer && type == SQLITE_FLOAT)
+		set_type(Type::Double);
+
+	switch(m_type) {
+		case Type::Integer:
+			m_integers.push_back(sqlite3_column_int64(stmt, index));
+			break;
+
+		case Type::Double:
+			m_doubles.push_back(sqlite3_column_double(stmt, index));
+			break;
+
+		default: {
+			// Pointer must be fetched before size to get the bytes of the right encoding
+			const char* data = static_cast<const char*>(sqlite3_column_blob(stmt, index));
+			m_bytes.append(data, static_cast<size_t>(sqlite3_column_bytes(stmt, index)));
+			m_offsets.push_back(m_bytes.size());
+			break;
+		}
+	}
+
+	if (m_size % 64 == 0)
+		m_validity.push_back(0);
+	m_validity.back() |= uint64_t(1) << (m_size % 64);
+	m_size++;
+}
+
+void Column::append_null() {
+	switch(m_type) {
+		case Type::Integer:
+			m_integers.push_back(0);
+			break;
+
+		case Type::Double:
+			m_doubles.push_back(0);
+			break;
+
+		case Type::String:
+			m_offsets.push_back(m_bytes.size());
+			break;
+
+		default:
+			break;
+	}
+
+	if (m_size % 64 == 0)
+		m_validity.push_back(0);
+	m_size++;
+}
+
+void Column::append(const Column& other) {
+	// Unifies types the way appending the other column's values one by one from SQLite would
+	if (m_type == Type::Null && other.m_type != Type::Null)
+		set_type(other.m_type);
+	else if (m_type == Type::Integer && other.m_type == Type::Double)
+		set_type(Type::Double);
+
+	for (size_t row = 0; row < other.m_size; row++) {
+		if (other.IsNull(row)) {
+			append_null();
+			continue;
+		}
+
+		switch(m_type) {
+			case Type::Integer:
+				m_integers.push_back(other.m_type == Type::Integer ? other.m_integers[row] : std::strtoll(std::string(other.Text(row)).c_str(), nullptr, 10));
+				break;
+
+			case Type::Double:
+				m_doubles.push_back(other.m_type == Type::Integer ? static_cast<double>(other.m_integers[row])
+					: other.m_type == Type::Double ? other.m_doubles[row] : std::strtod(std::string(other.Text(row)).c_str(), nullptr));
+				break;
+
+			default:
+				if (other.m_type == Type::String)
+					m_bytes.append(other.Text(row));
+				else if (other.m_type == Type::Integer)
+					m_bytes.append(std::to_string(other.m_integers[row]));
+				else {
+					char buffer[32];
+					const int length = std::snprintf(buffer, sizeof(buffer), "%.15g", other.m_doubles[row]);
+					m_bytes.append(buffer, static_cast<size_t>(length));
+				}
+				m_offsets.push_back(m_bytes.size());
+				break;
+		}
+
+		if (m_size % 64 == 0)
+			m_validity.push_back(0);
+		m_validity.back() |= uint64_t(1) << (m_size % 64);
+		m_size++;
+	}
+}
+
+void Column::set_type(const Type& type) {
+	switch(type) {
+		case Type::Integer:
+			m_integers.reserve(m_reserved);
+			m_integers.resize(m_size, 0);
+			break;
+
+		case Type::Double:
+			m_doubles.reserve(m_reserved);
+			if (m_type == Type::Integer) {
+				for (const auto& value: m_integers)
+					m_doubles.push_back(static_cast<double>(value));
+				m_integers = std::vector<int64_t>();
+			}
+			else
+				m_doubles.resize(m_size, 0);
+			break;
+
+		default:
+			m_offsets.reserve(m_reserved + 1);
+			m_offsets.resize(m_size + 1, 0);
+			break;
+	}
+	m_type = type;
+}
+
+void Column::reserve(const size_t& rows) {
+	// Data storage is reserved once its type is known
+	m_reserved = rows;
+	m_validity.reserve((rows + 63) / 64);
+}
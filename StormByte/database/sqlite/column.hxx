@@ -0,0 +1,60 @@
+#pragma once
+
+#ifdef STORMBYTE_ENABLE_SQLITE
+	#include <StormByte/database/sqlite/type.hxx>
+
+	#include <cstdint>
+	#include <string>
+	#include <string_view>
+	#include <vector>
+
+	class sqlite3_stmt;
+	namespace StormByte::Database::SQLite {
+		/**
+		 * Contiguous storage for a single result column. The storage type is taken
+		 * from the first non NULL value (integers are promoted to double if a real
+		 * value shows up later), other values are converted by SQLite. A column
+		 * which only contained NULLs keeps Type::Null and has empty storage.
+		 */
+		class STORMBYTE_PUBLIC Column {
+			friend class ColumnBatch;
+			friend class PreparedSTMT;
+			public:
+				Column(const Column&)					= default;
+				Column(Column&&) noexcept				= default;
+				Column& operator=(const Column&)		= default;
+				Column& operator=(Column&&) noexcept	= default;
+				~Column() noexcept						= default;
+
+				const std::string&				Name() const noexcept;
+				const Type&						GetType() const noexcept;
+				size_t							Size() const noexcept;
+				bool							IsNull(const size_t&) const;
+
+				const std::vector<int64_t>&		Integers() const;
+				const std::vector<double>&		Doubles() const;
+				const std::vector<size_t>&		Offsets() const;
+				const std::string&				Bytes() const;
+				std::string_view				Text(const size_t&) const;
+				// Bit i is set when row i is not NULL
+				const std::vector<uint64_t>&	Validity() const noexcept;
+
+			private:
+				Column(std::string&&);
+				void append(sqlite3_stmt*, const int&);
+				void append_null();
+				void append(const Column&);
+				void set_type(const Type&);
+				void reserve(const size_t&);
+
+				std::string m_name;
+				Type m_type;
+				size_t m_size, m_reserved;
+				std::vector<int64_t> m_integers;
+				std::vector<double> m_doubles;
+				std::vector<size_t> m_offsets;
+				std::string m_bytes;
+				std::vector<uint64_t> m_validity;
+		};
+	}
+#endif
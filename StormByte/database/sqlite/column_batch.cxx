@@ -0,0 +1,54 @@
+#include <StormByte/database/sqlite/column_batch.hxx>
+#include <StormByte/database/sqlite/exception.hxx>
+
+using namespace StormByte::Database::SQLite;
+
+void ColumnBatch::add(std::string&& name) {
+	m_column_name_assoc.insert({ name, m_columns.size() });
+	m_columns.push_back(Column(std::move(name)));
+}
+
+void ColumnBatch::reserve(const size_t& rows) {
+	for (auto& column: m_columns)
+		column.reserve(rows);
+}
+
+void ColumnBatch::append(const ColumnBatch& other) {
+	if (other.m_columns.size() != m_columns.size())
+		throw QueryError("Can not append a batch of " + std::to_string(other.m_columns.size()) + " columns to one of " + std::to_string(m_columns.size()));
+
+	for (size_t i = 0; i < m_columns.size(); i++)
+		m_columns[i].append(other.m_columns[i]);
+	m_rows += other.m_rows;
+}
+
+size_t ColumnBatch::Rows() const noexcept {
+	return m_rows;
+}
+
+size_t ColumnBatch::Columns() const noexcept {
+	return m_columns.size();
+}
+
+const Column& ColumnBatch::operator[](const size_t& pos) const {
+	return At(pos);
+}
+
+const Column& ColumnBatch::operator[](const std::string& name) const {
+	return At(name);
+}
+
+const Column& ColumnBatch::At(const size_t& pos) const {
+	if (pos >= m_columns.size())
+		throw OutOfBounds(m_columns.size(), pos);
+
+	return m_columns[pos];
+}
+
+const Column& ColumnBatch::At(const std::string& name) const {
+	auto it = m_column_name_assoc.find(name);
+	if (it == m_column_name_assoc.end())
+		throw OutOfBounds(name);
+
+	return m_columns[it->second];
+}
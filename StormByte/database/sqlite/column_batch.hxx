@@ -0,0 +1,37 @@
+#pragma once
+
+#ifdef STORMBYTE_ENABLE_SQLITE
+	#include <StormByte/database/sqlite/column.hxx>
+
+	#include <map>
+
+	namespace StormByte::Database::SQLite {
+		class STORMBYTE_PUBLIC ColumnBatch {
+			friend class PreparedSTMT;
+			friend class ShardedSQLite;
+			public:
+				ColumnBatch(const ColumnBatch&)					= default;
+				ColumnBatch(ColumnBatch&&) noexcept				= default;
+				ColumnBatch& operator=(const ColumnBatch&)		= default;
+				ColumnBatch& operator=(ColumnBatch&&) noexcept	= default;
+				~ColumnBatch() noexcept							= default;
+
+				size_t 			Rows() const noexcept;
+				size_t 			Columns() const noexcept;
+				const Column&	operator[](const size_t&) const;
+				const Column&	operator[](const std::string&) const;
+				const Column&	At(const size_t&) const;
+				const Column&	At(const std::string&) const;
+
+			private:
+				ColumnBatch()									= default;
+				void add(std::string&&);
+				void reserve(const size_t&);
+				void append(const ColumnBatch&); // Rows of a batch with the same columns
+
+				size_t m_rows = 0;
+				std::vector<Column> m_columns;
+				std::map<std::string, size_t> m_column_name_assoc;
+		};
+	}
+#endif
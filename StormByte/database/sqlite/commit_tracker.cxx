@@ -0,0 +1,255 @@
+#include <StormByte/database/sqlite/change_feed.hxx>
+#include <StormByte/database/sqlite/commit_tracker.hxx>
+#include <StormByte/database/sqlite/prepared_stmt.hxx>
+#include <StormByte/database/sqlite/preparer.hxx>
+#include <StormByte/database/sqlite/query_cache.hxx>
+
+#include <algorithm>
+#include <cstring>
+#include <iterator>
+#include <sqlite3.h>
+
+using namespace StormByte::Database::SQLite;
+
+namespace {
+	void add_table(std::vector<std::string>& tables, const char* table) {
+		if (std::find(tables.begin(), tables.end(), table) == tables.end())
+			tables.push_back(table);
+	}
+
+	char lower(const char& c) noexcept {
+		return c >= 'A' && c <= 'Z' ? static_cast<char>(c - 'A' + 'a') : c;
+	}
+
+	// Next keyword or (unquoted) name lower cased, skipping whitespace and comments; empty when there is none
+	std::string token(const char*& sql) {
+		while (*sql) {
+			if (*sql == ' ' || *sql == '\t' || *sql == '\n' || *sql == '\r' || *sql == '\f')
+				sql++;
+			else if (sql[0] == '-' && sql[1] == '-') {
+				while (*sql && *sql != '\n')
+					sql++;
+			}
+			else if (sql[0] == '/' && sql[1] == '*') {
+				const char* end = std::strstr(sql + 2, "*/");
+				sql = end ? end + 2 : sql + std::strlen(sql);
+			}
+			else
+				break;
+		}
+
+		std::string word;
+		if (*sql == '"' || *sql == '\'' || *sql == '`' || *sql == '[') {
+			const char close = *sql == '[' ? ']' : *sql;
+			for (sql++; *sql; sql++) {
+				if (*sql == close) {
+					// Doubled quotes stand for one
+					if (close != ']' && sql[1] == close)
+						sql++;
+					else {
+						sql++;
+						break;
+					}
+				}
+				word += lower(*sql);
+			}
+		}
+		else {
+			while ((*sql >= 'a' && *sql <= 'z') || (*sql >= 'A' && *sql <= 'Z') || (*sql >= '0' && *sql <= '9') || *sql == '_'
+				|| static_cast<unsigned char>(*sql) >= 0x80)
+				word += lower(*sql++);
+		}
+		return word;
+	}
+}
+
+CommitTracker::Recording::Recording(CommitTracker& tracker, std::shared_ptr<StatementTables>& tables):m_tracker(tracker) {
+	if (m_tracker.m_installed && m_tracker.m_query_cache) {
+		tables = std::make_shared<StatementTables>();
+		m_tracker.m_recording = tables.get();
+	}
+}
+
+CommitTracker::Recording::~Recording() noexcept {
+	m_tracker.m_recording = nullptr;
+}
+
+CommitTracker::CommitTracker() noexcept:m_commit_attempted(false), m_installed(false), m_recording(nullptr) {}
+
+void CommitTracker::install(sqlite3* database) noexcept {
+	// Setting an authorizer expires every compiled statement, so it is done once and never removed
+	if (!m_installed) {
+		sqlite3_set_authorizer(database, &authorizer, this);
+		m_installed = true;
+	}
+}
+
+void CommitTracker::attach(std::shared_ptr<ChangeFeed> change_feed, std::shared_ptr<QueryCache> query_cache) noexcept {
+	m_change_feed = std::move(change_feed);
+	m_query_cache = std::move(query_cache);
+	std::lock_guard<std::mutex> lock(m_mutex);
+	if (!active()) {
+		m_commit_attempted = false;
+		m_savepoints.clear();
+	}
+}
+
+bool CommitTracker::active() const noexcept {
+	return m_change_feed || m_query_cache;
+}
+
+size_t CommitTracker::mark() const noexcept {
+	return m_change_feed ? m_change_feed->mark() : 0;
+}
+
+void CommitTracker::finished(PreparedSTMT& prepared, const int& rc) {
+	if (!active())
+		return;
+
+	sqlite3_stmt* stmt = prepared.m_stmt;
+	const size_t& mark = prepared.m_change_mark;
+	if (rc != SQLITE_DONE) {
+		// A failed COMMIT leaves the transaction open; a failed write undid its own changes, unless
+		// the whole transaction rolled back which the rollback hook already handled
+		m_commit_attempted = false;
+		if (m_change_feed && !sqlite3_stmt_readonly(stmt))
+			m_change_feed->rollback_to(mark);
+		return;
+	}
+
+	// Transaction control statements are the read only ones
+	if (sqlite3_stmt_readonly(stmt))
+		savepoint(sqlite3_sql(stmt));
+	else if (m_query_cache) {
+		// The update hook misses WITHOUT ROWID tables and DELETE without WHERE, which truncates
+		for (const std::string& table: tables(prepared).written)
+			m_query_cache->changed(table);
+	}
+	if (m_commit_attempted && sqlite3_get_autocommit(sqlite3_db_handle(stmt)) && m_commit_attempted.exchange(false)) {
+		{
+			std::lock_guard<std::mutex> lock(m_mutex);
+			m_savepoints.clear();
+		}
+		if (m_query_cache)
+			m_query_cache->committed();
+		if (m_change_feed)
+			m_change_feed->committed();
+	}
+}
+
+int CommitTracker::commit_callback(void* data) {
+	static_cast<CommitTracker*>(data)->m_commit_attempted = true;
+	return 0;
+}
+
+void CommitTracker::rollback_callback(void* data) {
+	CommitTracker* tracker = static_cast<CommitTracker*>(data);
+	tracker->m_commit_attempted = false;
+	{
+		std::lock_guard<std::mutex> lock(tracker->m_mutex);
+		tracker->m_savepoints.clear();
+	}
+	if (tracker->m_query_cache)
+		tracker->m_query_cache->rolled_back();
+	if (tracker->m_change_feed)
+		tracker->m_change_feed->rolled_back();
+}
+
+void CommitTracker::savepoint(const char* sql) {
+	if (!sql)
+		return;
+
+	std::string word = token(sql);
+	std::lock_guard<std::mutex> lock(m_mutex);
+	const bool release = word == "release";
+	if (word == "savepoint") {
+		std::string name = token(sql);
+		m_savepoints.push_back({ std::move(name), mark() });
+		return;
+	}
+	else if (word == "rollback") {
+		word = token(sql);
+		if (word == "transaction")
+			word = token(sql);
+		if (word != "to")
+			return; // A full rollback, reported by the rollback hook
+	}
+	else if (!release)
+		return;
+
+	std::string name = token(sql);
+	if (name == "savepoint")
+		name = token(sql);
+	auto it = m_savepoints.rbegin();
+	while (it != m_savepoints.rend() && it->name != name)
+		++it;
+
+	if (release) {
+		// Releasing one releases every savepoint opened after it
+		if (it != m_savepoints.rend())
+			m_savepoints.erase(std::prev(it.base()), m_savepoints.end());
+	}
+	else {
+		// Rolling back to a savepoint fires no rollback hook and keeps it open
+		if (it != m_savepoints.rend()) {
+			if (m_change_feed)
+				m_change_feed->rollback_to(it->mark);
+			m_savepoints.erase(it.base(), m_savepoints.end());
+		}
+		if (m_query_cache)
+			m_query_cache->invalidate_dirty();
+	}
+}
+
+const StatementTables& CommitTracker::tables(PreparedSTMT& prepared) {
+	if (!prepared.m_tables) {
+		// Compiled before there was a query cache or in the background, where nothing is recorded
+		std::shared_ptr<StatementTables> tables;
+		sqlite3* database = sqlite3_db_handle(prepared.m_stmt);
+		const Preparer::ErrorLock lock(database);
+		{
+			const Recording recording(*this, tables);
+			sqlite3_stmt* compiled = nullptr;
+			sqlite3_prepare_v2(database, prepared.m_query.c_str(), static_cast<int>(prepared.m_query.length()), &compiled, nullptr);
+			sqlite3_finalize(compiled);
+		}
+		// Nothing is recorded without a query cache, which is the only one asking
+		if (!tables) {
+			static const StatementTables none;
+			return none;
+		}
+		prepared.m_tables = std::move(tables);
+	}
+	return *prepared.m_tables;
+}
+
+int CommitTracker::authorizer(void* data, int action, const char* arg1, const char* arg2, const char*, const char*) {
+	StatementTables* tables = static_cast<CommitTracker*>(data)->m_recording;
+	if (!tables)
+		return SQLITE_OK;
+
+	switch(action) {
+		case SQLITE_READ:
+			if (arg1)
+				add_table(tables->read, arg1);
+			break;
+
+		case SQLITE_INSERT:
+		case SQLITE_UPDATE:
+		case SQLITE_DELETE:
+		case SQLITE_DROP_TABLE:
+		case SQLITE_DROP_TEMP_TABLE:
+			if (arg1)
+				add_table(tables->written, arg1);
+			break;
+
+		case SQLITE_ALTER_TABLE:
+			if (arg2)
+				add_table(tables->written, arg2);
+			break;
+
+		default:
+			break;
+	}
+	return SQLITE_OK;
+}
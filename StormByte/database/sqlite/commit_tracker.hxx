@@ -0,0 +1,90 @@
+#pragma once
+
+#ifdef STORMBYTE_ENABLE_SQLITE
+	#include <StormByte/visibility.h>
+
+	#include <atomic>
+	#include <memory>
+	#include <mutex>
+	#include <string>
+	#include <vector>
+
+	class sqlite3;
+	namespace StormByte::Database::SQLite {
+		class ChangeFeed;
+		class PreparedSTMT;
+		class QueryCache;
+		// Tables a statement reads and writes, as the authorizer reports them when it is compiled
+		struct STORMBYTE_PRIVATE StatementTables {
+			std::vector<std::string> read;
+			std::vector<std::string> written;
+		};
+
+		/**
+		 * Settles the change feed and the query cache of a connection when statements
+		 * finish. The commit hook runs before the commit is attempted, so it only flags
+		 * it and changes are published once the statement that committed is done.
+		 * Savepoints are followed from the statements opening, releasing or rolling
+		 * back to them, whoever ran them. Finished writes invalidate the tables they
+		 * write to, including those the update hook misses. Statements may finish on
+		 * any thread, the group committer's included.
+		 */
+		class STORMBYTE_PRIVATE CommitTracker {
+			public:
+				/**
+				 * Tables of what the caller compiles while it lives, only when there is a
+				 * query cache; the caller holds the connection mutex meanwhile.
+				 */
+				class STORMBYTE_PRIVATE Recording {
+					public:
+						Recording(CommitTracker&, std::shared_ptr<StatementTables>&);
+						Recording(const Recording&)				= delete;
+						Recording(Recording&&)					= delete;
+						Recording& operator=(const Recording&)	= delete;
+						Recording& operator=(Recording&&)		= delete;
+						~Recording() noexcept;
+
+					private:
+						CommitTracker& m_tracker;
+				};
+
+				CommitTracker() noexcept;
+				CommitTracker(const CommitTracker&)				= delete;
+				CommitTracker(CommitTracker&&)					= delete;
+				CommitTracker& operator=(const CommitTracker&)	= delete;
+				CommitTracker& operator=(CommitTracker&&)		= delete;
+				~CommitTracker() noexcept						= default;
+
+				// Installs the authorizer Recording relies on, once and before anything is compiled
+				void install(sqlite3*) noexcept;
+				void attach(std::shared_ptr<ChangeFeed>, std::shared_ptr<QueryCache>) noexcept;
+				bool active() const noexcept;
+				// Change feed position when a statement starts running
+				size_t mark() const noexcept;
+				// SQLITE_DONE or the error the statement failed with
+				void finished(PreparedSTMT&, const int&);
+				// Recorded when the statement was compiled, otherwise by compiling a copy now; none without a query cache
+				const StatementTables& tables(PreparedSTMT&);
+
+				static int commit_callback(void*);
+				static void rollback_callback(void*);
+				static int authorizer(void*, int, const char*, const char*, const char*, const char*);
+
+			private:
+				struct Savepoint {
+					std::string name;	// Lower case, SQLite compares them case insensitively
+					size_t mark;		// Change feed position when it was opened
+				};
+
+				std::shared_ptr<ChangeFeed> m_change_feed;
+				std::shared_ptr<QueryCache> m_query_cache;
+				std::atomic<bool> m_commit_attempted;
+				std::mutex m_mutex; // For the savepoints, never held while calling SQLite
+				std::vector<Savepoint> m_savepoints;
+				bool m_installed;
+				StatementTables* m_recording; // Only set with the connection mutex held, by the thread compiling
+
+				void savepoint(const char*);
+		};
+	}
+#endif
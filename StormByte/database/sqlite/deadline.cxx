@@ -0,0 +1,45 @@
+#include <StormByte/database/sqlite/busy_handler.hxx>
+#include <StormByte/database/sqlite/deadline.hxx>
+
+#include <sqlite3.h>
+
+using namespace StormByte::Database::SQLite;
+
+namespace {
+	// Innermost deadline of this thread, only read here so the progress handler takes no lock
+	thread_local Deadline* innermost = nullptr;
+}
+
+Deadline::Deadline(sqlite3* database, const std::chrono::steady_clock::time_point& deadline, BusyHandler& busy_handler) noexcept:
+m_database(database), m_busy_handler(busy_handler), m_deadline(deadline), m_outer(innermost) {
+	innermost = this;
+	// The progress handler is one per connection, installed while any thread has a deadline on it
+	std::lock_guard<std::mutex> lock(m_busy_handler.m_deadline_mutex);
+	if (m_busy_handler.m_deadlines++ == 0)
+		sqlite3_progress_handler(m_database, CHECK_INTERVAL, &Deadline::callback, &m_busy_handler);
+}
+
+Deadline::~Deadline() noexcept {
+	innermost = m_outer;
+	std::lock_guard<std::mutex> lock(m_busy_handler.m_deadline_mutex);
+	if (--m_busy_handler.m_deadlines == 0)
+		sqlite3_progress_handler(m_database, 0, nullptr, nullptr);
+}
+
+bool Deadline::Expired() const noexcept {
+	return std::chrono::steady_clock::now() >= m_deadline;
+}
+
+std::chrono::steady_clock::time_point Deadline::Current(const BusyHandler* busy_handler) noexcept {
+	auto deadline = std::chrono::steady_clock::time_point::max();
+	for (const Deadline* current = innermost; current; current = current->m_outer) {
+		if (&current->m_busy_handler == busy_handler && current->m_deadline < deadline)
+			deadline = current->m_deadline;
+	}
+	return deadline;
+}
+
+int Deadline::callback(void* data) noexcept {
+	// Runs on the thread stepping, non zero makes its statement fail with SQLITE_INTERRUPT
+	return std::chrono::steady_clock::now() >= Current(static_cast<const BusyHandler*>(data)) ? 1 : 0;
+}
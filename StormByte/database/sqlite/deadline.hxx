@@ -0,0 +1,43 @@
+#pragma once
+
+#ifdef STORMBYTE_ENABLE_SQLITE
+	#include <StormByte/visibility.h>
+
+	#include <chrono>
+
+	class sqlite3;
+	namespace StormByte::Database::SQLite {
+		class BusyHandler;
+		/**
+		 * Interrupts what its thread runs on the connection once the deadline passes,
+		 * through the progress handler, for as long as the object lives; the busy
+		 * handler stops waiting for locks at the deadline too. Deadlines nest and
+		 * other threads may have their own meanwhile: each thread is held to the
+		 * earliest of its own on that connection.
+		 */
+		class STORMBYTE_PRIVATE Deadline {
+			public:
+				// VM instructions between clock checks
+				static constexpr int CHECK_INTERVAL = 1000;
+
+				Deadline(sqlite3*, const std::chrono::steady_clock::time_point&, BusyHandler&) noexcept;
+				Deadline(const Deadline&)				= delete;
+				Deadline(Deadline&&)					= delete;
+				Deadline& operator=(const Deadline&)	= delete;
+				Deadline& operator=(Deadline&&)			= delete;
+				~Deadline() noexcept;
+
+				bool Expired() const noexcept;
+				// Earliest deadline the calling thread has on the busy handler's connection, max when none
+				static std::chrono::steady_clock::time_point Current(const BusyHandler*) noexcept;
+
+			private:
+				sqlite3* m_database;
+				BusyHandler& m_busy_handler;
+				std::chrono::steady_clock::time_point m_deadline;
+				Deadline* m_outer; // Started earlier on the same thread, on any connection
+
+				static int callback(void*) noexcept;
+		};
+	}
+#endif
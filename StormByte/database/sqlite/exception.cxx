@@ -30,6 +30,10 @@ std::string WrongResultType::type_to_string(const Type& type) const {
 		case Type::String:
 			t = "string";
 			break;
+
+		case Type::Double:
+			t = "double";
+			break;
 	}
 	return t;
 }
@@ -56,3 +60,15 @@ Exception(reason) {}
 
 QueryError::QueryError(std::string&& reason):
 Exception(std::move(reason)) {}
+
+DatabaseBusy::DatabaseBusy(const std::string& reason):
+QueryError(reason) {}
+
+DatabaseBusy::DatabaseBusy(std::string&& reason):
+QueryError(std::move(reason)) {}
+
+QueryInterrupted::QueryInterrupted(const std::string& reason):
+QueryError(reason) {}
+
+QueryInterrupted::QueryInterrupted(std::string&& reason):
+QueryError(std::move(reason)) {}
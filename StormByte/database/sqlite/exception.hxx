@@ -76,5 +76,28 @@
 				QueryError& operator=(QueryError&&) noexcept 	= default;
 				~QueryError() noexcept override					= default;
 		};
+
+		class STORMBYTE_PUBLIC DatabaseBusy: public QueryError {
+			public:
+				DatabaseBusy(const std::string&);
+				DatabaseBusy(std::string&&);
+				DatabaseBusy(const DatabaseBusy&)					= default;
+				DatabaseBusy(DatabaseBusy&&) noexcept				= default;
+				DatabaseBusy& operator=(const DatabaseBusy&)		= default;
+				DatabaseBusy& operator=(DatabaseBusy&&) noexcept 	= default;
+				~DatabaseBusy() noexcept override					= default;
+		};
+
+		// Query stopped by a cancellation or because it ran past its deadline
+		class STORMBYTE_PUBLIC QueryInterrupted: public QueryError {
+			public:
+				QueryInterrupted(const std::string&);
+				QueryInterrupted(std::string&&);
+				QueryInterrupted(const QueryInterrupted&)					= default;
+				QueryInterrupted(QueryInterrupted&&) noexcept				= default;
+				QueryInterrupted& operator=(const QueryInterrupted&)		= default;
+				QueryInterrupted& operator=(QueryInterrupted&&) noexcept 	= default;
+				~QueryInterrupted() noexcept override						= default;
+		};
 	}
 #endif
\ No newline at end of file
@@ -0,0 +1,231 @@
+#include <StormByte/database/sqlite/exporter.hxx>
+
+#include <charconv>
+#include <cmath>
+#include <cstring>
+#include <sqlite3.h>
+
+using namespace StormByte::Database::SQLite;
+
+namespace {
+	template<typename T> void number(std::string& out, const T& value) {
+		char digits[32];
+		const auto result = std::to_chars(digits, digits + sizeof(digits), value);
+		out.append(digits, static_cast<size_t>(result.ptr - digits));
+	}
+
+	void little_endian(std::string& out, uint64_t value, const int& bytes) {
+		for (int i = 0; i < bytes; i++, value >>= 8)
+			out.push_back(static_cast<char>(value & 0xFF));
+	}
+
+	void tsv_escape(std::string& out, const char* data, const size_t& size) {
+		const char* run = data;
+		for (const char* p = data; p < data + size; p++) {
+			const char c = *p;
+			if (c != '\t' && c != '\n' && c != '\r' && c != '\\')
+				continue;
+			out.append(run, static_cast<size_t>(p - run));
+			out.push_back('\\');
+			out.push_back(c == '\t' ? 't' : c == '\n' ? 'n' : c == '\r' ? 'r' : '\\');
+			run = p + 1;
+		}
+		out.append(run, static_cast<size_t>(data + size - run));
+	}
+
+	void json_escape(std::string& out, const char* data, const size_t& size) {
+		static constexpr char HEX[] = "0123456789abcdef";
+		out.push_back('"');
+		const char* run = data;
+		for (const char* p = data; p < data + size; p++) {
+			const unsigned char c = static_cast<unsigned char>(*p);
+			if (c >= 0x20 && c != '"' && c != '\\')
+				continue;
+			out.append(run, static_cast<size_t>(p - run));
+			switch(c) {
+				case '"':	out += "\\\""; break;
+				case '\\':	out += "\\\\"; break;
+				case '\n':	out += "\\n"; break;
+				case '\r':	out += "\\r"; break;
+				case '\t':	out += "\\t"; break;
+				default:
+					out += "\\u00";
+					out.push_back(HEX[c >> 4]);
+					out.push_back(HEX[c & 0xF]);
+					break;
+			}
+			run = p + 1;
+		}
+		out.append(run, static_cast<size_t>(data + size - run));
+		out.push_back('"');
+	}
+
+	void base64(std::string& out, const unsigned char* data, const size_t& size) {
+		static constexpr char ALPHABET[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+		out.push_back('"');
+		size_t i = 0;
+		for (; i + 3 <= size; i += 3) {
+			const uint32_t group = (uint32_t(data[i]) << 16) | (uint32_t(data[i + 1]) << 8) | data[i + 2];
+			out.push_back(ALPHABET[group >> 18]);
+			out.push_back(ALPHABET[(group >> 12) & 0x3F]);
+			out.push_back(ALPHABET[(group >> 6) & 0x3F]);
+			out.push_back(ALPHABET[group & 0x3F]);
+		}
+		if (i < size) {
+			const uint32_t group = (uint32_t(data[i]) << 16) | (i + 1 < size ? uint32_t(data[i + 1]) << 8 : 0);
+			out.push_back(ALPHABET[group >> 18]);
+			out.push_back(ALPHABET[(group >> 12) & 0x3F]);
+			out.push_back(i + 1 < size ? ALPHABET[(group >> 6) & 0x3F] : '=');
+			out.push_back('=');
+		}
+		out.push_back('"');
+	}
+}
+
+Exporter::Exporter(sqlite3_stmt* stmt, const ExportFormat& format, const size_t& flush_size):m_stmt(stmt), m_format(format),
+m_flush_size(flush_size > 0 ? flush_size : 1), m_columns(sqlite3_column_count(stmt)), m_rows(0) {
+	if (m_format == ExportFormat::JSONLines) {
+		for (int i = 0; i < m_columns; i++) {
+			std::string key(i == 0 ? "{" : ",");
+			const char* name = sqlite3_column_name(m_stmt, i);
+			json_escape(key, name, std::strlen(name));
+			m_keys.push_back(key + ":");
+		}
+	}
+	// A row or two past the flush size
+	m_buffer.reserve(m_flush_size + 4096);
+}
+
+void Exporter::append() {
+	switch(m_format) {
+		case ExportFormat::JSONLines:
+			json();
+			break;
+
+		case ExportFormat::Binary:
+			binary();
+			break;
+
+		default:
+			tsv();
+			break;
+	}
+	m_rows++;
+}
+
+bool Exporter::full() const noexcept {
+	return m_buffer.size() >= m_flush_size;
+}
+
+const std::string& Exporter::buffer() const noexcept {
+	return m_buffer;
+}
+
+size_t Exporter::rows() const noexcept {
+	return m_rows;
+}
+
+void Exporter::clear() noexcept {
+	m_buffer.clear();
+	m_rows = 0;
+}
+
+void Exporter::tsv() {
+	for (int i = 0; i < m_columns; i++) {
+		if (i > 0)
+			m_buffer.push_back('\t');
+		switch(sqlite3_column_type(m_stmt, i)) {
+			case SQLITE_INTEGER:
+				number(m_buffer, static_cast<int64_t>(sqlite3_column_int64(m_stmt, i)));
+				break;
+
+			case SQLITE_FLOAT:
+				number(m_buffer, sqlite3_column_double(m_stmt, i));
+				break;
+
+			case SQLITE_NULL:
+				m_buffer += "\\N";
+				break;
+
+			default: {
+				const char* data = static_cast<const char*>(sqlite3_column_blob(m_stmt, i));
+				tsv_escape(m_buffer, data ? data : "", static_cast<size_t>(sqlite3_column_bytes(m_stmt, i)));
+				break;
+			}
+		}
+	}
+	m_buffer.push_back('\n');
+}
+
+void Exporter::json() {
+	for (int i = 0; i < m_columns; i++) {
+		m_buffer += m_keys[i];
+		switch(sqlite3_column_type(m_stmt, i)) {
+			case SQLITE_INTEGER:
+				number(m_buffer, static_cast<int64_t>(sqlite3_column_int64(m_stmt, i)));
+				break;
+
+			case SQLITE_FLOAT: {
+				const double value = sqlite3_column_double(m_stmt, i);
+				if (std::isfinite(value))
+					number(m_buffer, value);
+				else
+					m_buffer += "null";
+				break;
+			}
+
+			case SQLITE_NULL:
+				m_buffer += "null";
+				break;
+
+			case SQLITE_BLOB: {
+				const unsigned char* data = static_cast<const unsigned char*>(sqlite3_column_blob(m_stmt, i));
+				base64(m_buffer, data, static_cast<size_t>(sqlite3_column_bytes(m_stmt, i)));
+				break;
+			}
+
+			default: {
+				const char* data = reinterpret_cast<const char*>(sqlite3_column_text(m_stmt, i));
+				json_escape(m_buffer, data, static_cast<size_t>(sqlite3_column_bytes(m_stmt, i)));
+				break;
+			}
+		}
+	}
+	m_buffer += m_columns > 0 ? "}\n" : "{}\n";
+}
+
+void Exporter::binary() {
+	const size_t start = m_buffer.size();
+	little_endian(m_buffer, 0, 4); // Payload length, filled in once known
+	for (int i = 0; i < m_columns; i++) {
+		const int type = sqlite3_column_type(m_stmt, i);
+		m_buffer.push_back(static_cast<char>(type));
+		switch(type) {
+			case SQLITE_INTEGER:
+				little_endian(m_buffer, static_cast<uint64_t>(sqlite3_column_int64(m_stmt, i)), 8);
+				break;
+
+			case SQLITE_FLOAT: {
+				const double value = sqlite3_column_double(m_stmt, i);
+				uint64_t bits;
+				std::memcpy(&bits, &value, sizeof(bits));
+				little_endian(m_buffer, bits, 8);
+				break;
+			}
+
+			case SQLITE_NULL:
+				break;
+
+			default: {
+				const char* data = static_cast<const char*>(sqlite3_column_blob(m_stmt, i));
+				const size_t size = static_cast<size_t>(sqlite3_column_bytes(m_stmt, i));
+				little_endian(m_buffer, size, 4);
+				m_buffer.append(data ? data : "", size);
+				break;
+			}
+		}
+	}
+	const uint64_t length = m_buffer.size() - start - 4;
+	for (int i = 0; i < 4; i++)
+		m_buffer[start + static_cast<size_t>(i)] = static_cast<char>((length >> (8 * i)) & 0xFF);
+}
@@ -0,0 +1,60 @@
+#pragma once
+
+#ifdef STORMBYTE_ENABLE_SQLITE
+	#include <StormByte/visibility.h>
+
+	#include <cstdint>
+	#include <string>
+	#include <vector>
+
+	class sqlite3_stmt;
+	namespace StormByte::Database::SQLite {
+		/**
+		 * TSV:		one line per row, tab separated, NULL as \N and backslash escapes for tab, newline, carriage return and backslash
+		 * JSONLines:	one object per row keyed by column name, blobs as base64 strings
+		 * Binary:		per row a little endian u32 payload length, then per column a type byte (SQLite's type codes)
+		 *			followed by an i64, a double, or a u32 length and the bytes; NULL has no payload
+		 */
+		enum class STORMBYTE_PUBLIC ExportFormat: unsigned short { TSV = 0, JSONLines, Binary };
+
+		struct STORMBYTE_PUBLIC ExportStatistics {
+			uint64_t rows				= 0;	// Rows handed to the sink
+			uint64_t bytes				= 0;
+			bool complete				= true;	// False when the sink stopped accepting data
+		};
+
+		/**
+		 * Serializes the current row of a statement straight from its columns into
+		 * a buffer which is reused for the whole export, without building rows.
+		 */
+		class STORMBYTE_PRIVATE Exporter {
+			public:
+				Exporter(sqlite3_stmt*, const ExportFormat&, const size_t&);
+				Exporter(const Exporter&)				= delete;
+				Exporter(Exporter&&)					= delete;
+				Exporter& operator=(const Exporter&)	= delete;
+				Exporter& operator=(Exporter&&)			= delete;
+				~Exporter() noexcept					= default;
+
+				void append();
+				// Reached the flush size, whole rows only so binary rows are never split
+				bool full() const noexcept;
+				const std::string& buffer() const noexcept;
+				size_t rows() const noexcept; // Rows in the buffer
+				void clear() noexcept;
+
+			private:
+				void tsv();
+				void json();
+				void binary();
+
+				sqlite3_stmt* m_stmt;
+				ExportFormat m_format;
+				size_t m_flush_size;
+				int m_columns;
+				std::vector<std::string> m_keys; // Escaped "name": prefixes for JSON
+				std::string m_buffer;
+				size_t m_rows;
+		};
+	}
+#endif
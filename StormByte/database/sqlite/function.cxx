@@ -0,0 +1,75 @@
+#include <StormByte/database/sqlite/function.hxx>
+
+#include <sqlite3.h>
+
+using namespace StormByte::Database::SQLite;
+
+StormByte::Database::SQLite::Type Function::type(sqlite3_value* value) noexcept {
+	switch(sqlite3_value_type(value)) {
+		case SQLITE_INTEGER:
+			return Type::Integer;
+
+		case SQLITE_FLOAT:
+			return Type::Double;
+
+		case SQLITE_NULL:
+			return Type::Null;
+
+		default:
+			return Type::String;
+	}
+}
+
+bool Function::is_null(sqlite3_value* value) noexcept {
+	return sqlite3_value_type(value) == SQLITE_NULL;
+}
+
+bool Function::is_text(sqlite3_value* value) noexcept {
+	return sqlite3_value_type(value) == SQLITE_TEXT;
+}
+
+int64_t Function::to_integer(sqlite3_value* value) noexcept {
+	return sqlite3_value_int64(value);
+}
+
+double Function::to_double(sqlite3_value* value) noexcept {
+	return sqlite3_value_double(value);
+}
+
+std::string_view Function::to_text(sqlite3_value* value) noexcept {
+	const char* text = reinterpret_cast<const char*>(sqlite3_value_text(value));
+	return text ? std::string_view(text, static_cast<size_t>(sqlite3_value_bytes(value))) : std::string_view();
+}
+
+void Function::set_null(sqlite3_context* ctx) noexcept {
+	sqlite3_result_null(ctx);
+}
+
+void Function::set_integer(sqlite3_context* ctx, const int64_t& value) noexcept {
+	sqlite3_result_int64(ctx, value);
+}
+
+void Function::set_double(sqlite3_context* ctx, const double& value) noexcept {
+	sqlite3_result_double(ctx, value);
+}
+
+void Function::set_text(sqlite3_context* ctx, const std::string_view& value) noexcept {
+	sqlite3_result_text64(ctx, value.data(), value.size(), SQLITE_TRANSIENT, SQLITE_UTF8);
+}
+
+void Function::set_error(sqlite3_context* ctx, const char* message) noexcept {
+	sqlite3_result_error(ctx, message, -1);
+}
+
+void Function::set_nomem(sqlite3_context* ctx) noexcept {
+	sqlite3_result_error_nomem(ctx);
+}
+
+void* Function::user_data(sqlite3_context* ctx) noexcept {
+	return sqlite3_user_data(ctx);
+}
+
+void** Function::state_slot(sqlite3_context* ctx, const bool& allocate) noexcept {
+	// Zero filled by SQLite on first allocation
+	return static_cast<void**>(sqlite3_aggregate_context(ctx, allocate ? static_cast<int>(sizeof(void*)) : 0));
+}
@@ -0,0 +1,214 @@
+#pragma once
+
+#ifdef STORMBYTE_ENABLE_SQLITE
+	#include <StormByte/database/sqlite/type.hxx>
+
+	#include <cstdint>
+	#include <exception>
+	#include <memory>
+	#include <new>
+	#include <optional>
+	#include <string>
+	#include <string_view>
+	#include <tuple>
+	#include <type_traits>
+	#include <utility>
+
+	class sqlite3_context;
+	class sqlite3_value;
+
+	/**
+	 * Marshalling between sqlite3_value arguments/sqlite3_context results and C++
+	 * types used by SQLite3::register_function and SQLite3::register_aggregate.
+	 * Supported argument types are integers, bool, floating point, std::string,
+	 * std::string_view (only valid during the call) and std::optional of them for
+	 * NULL aware arguments; results may also be std::nullptr_t.
+	 */
+	namespace StormByte::Database::SQLite::Function {
+		STORMBYTE_PUBLIC Type				type(sqlite3_value*) noexcept; // Blobs are reported as String
+		STORMBYTE_PUBLIC bool				is_null(sqlite3_value*) noexcept;
+		STORMBYTE_PUBLIC bool				is_text(sqlite3_value*) noexcept;
+		STORMBYTE_PUBLIC int64_t			to_integer(sqlite3_value*) noexcept;
+		STORMBYTE_PUBLIC double				to_double(sqlite3_value*) noexcept;
+		STORMBYTE_PUBLIC std::string_view	to_text(sqlite3_value*) noexcept;
+		STORMBYTE_PUBLIC void				set_null(sqlite3_context*) noexcept;
+		STORMBYTE_PUBLIC void				set_integer(sqlite3_context*, const int64_t&) noexcept;
+		STORMBYTE_PUBLIC void				set_double(sqlite3_context*, const double&) noexcept;
+		STORMBYTE_PUBLIC void				set_text(sqlite3_context*, const std::string_view&) noexcept;
+		STORMBYTE_PUBLIC void				set_error(sqlite3_context*, const char*) noexcept;
+		STORMBYTE_PUBLIC void				set_nomem(sqlite3_context*) noexcept;
+		STORMBYTE_PUBLIC void*				user_data(sqlite3_context*) noexcept;
+		// Per group storage for an aggregate state pointer, nullptr if never allocated and allocate is false
+		STORMBYTE_PUBLIC void**				state_slot(sqlite3_context*, const bool&) noexcept;
+
+		template<typename T> struct Argument {
+			static_assert(!sizeof(T), "Unsupported SQL function argument type");
+		};
+		template<typename T> requires std::is_integral_v<T> struct Argument<T> {
+			static T get(sqlite3_value* v) { return static_cast<T>(to_integer(v)); }
+		};
+		template<> struct Argument<bool> {
+			static bool get(sqlite3_value* v) { return to_integer(v) != 0; }
+		};
+		template<typename T> requires std::is_floating_point_v<T> struct Argument<T> {
+			static T get(sqlite3_value* v) { return static_cast<T>(to_double(v)); }
+		};
+		template<> struct Argument<std::string_view> {
+			static std::string_view get(sqlite3_value* v) { return to_text(v); }
+		};
+		template<> struct Argument<std::string> {
+			static std::string get(sqlite3_value* v) { return std::string(to_text(v)); }
+		};
+		template<typename T> struct Argument<std::optional<T>> {
+			static std::optional<T> get(sqlite3_value* v) {
+				return is_null(v) ? std::nullopt : std::optional<T>(Argument<T>::get(v));
+			}
+		};
+
+		inline void set_result(sqlite3_context* ctx, std::nullptr_t) { set_null(ctx); }
+		template<typename T> requires std::is_integral_v<T> void set_result(sqlite3_context* ctx, const T& value) {
+			set_integer(ctx, static_cast<int64_t>(value));
+		}
+		template<typename T> requires std::is_floating_point_v<T> void set_result(sqlite3_context* ctx, const T& value) {
+			set_double(ctx, static_cast<double>(value));
+		}
+		inline void set_result(sqlite3_context* ctx, const std::string& value) { set_text(ctx, value); }
+		inline void set_result(sqlite3_context* ctx, const std::string_view& value) { set_text(ctx, value); }
+		inline void set_result(sqlite3_context* ctx, const char* value) { set_text(ctx, value); }
+		template<typename T> void set_result(sqlite3_context* ctx, const std::optional<T>& value) {
+			if (value)
+				set_result(ctx, *value);
+			else
+				set_null(ctx);
+		}
+
+		// Signature of lambdas, function objects, function pointers and member functions
+		template<typename T> struct Traits: Traits<decltype(&T::operator())> {};
+		template<typename R, typename... A> struct Traits<R(*)(A...)> {
+			using Return = R;
+			using Arguments = std::tuple<std::decay_t<A>...>;
+			static constexpr int arity = sizeof...(A);
+		};
+		template<typename R, typename... A> struct Traits<R(A...)>: Traits<R(*)(A...)> {};
+		template<typename C, typename R, typename... A> struct Traits<R(C::*)(A...)>: Traits<R(*)(A...)> {};
+		template<typename C, typename R, typename... A> struct Traits<R(C::*)(A...) const>: Traits<R(*)(A...)> {};
+
+		template<typename Args, size_t... I> Args arguments(sqlite3_value** argv, std::index_sequence<I...>) {
+			return Args { Argument<std::tuple_element_t<I, Args>>::get(argv[I])... };
+		}
+
+		template<typename Args> Args arguments(sqlite3_value** argv) {
+			return arguments<Args>(argv, std::make_index_sequence<std::tuple_size_v<Args>>());
+		}
+
+		template<typename F> void scalar(sqlite3_context* ctx, int, sqlite3_value** argv) {
+			try {
+				F& function = *static_cast<F*>(user_data(ctx));
+				set_result(ctx, std::apply(function, arguments<typename Traits<F>::Arguments>(argv)));
+			}
+			catch (const std::bad_alloc&) {
+				set_nomem(ctx);
+			}
+			catch (const std::exception& e) {
+				set_error(ctx, e.what());
+			}
+			catch (...) {
+				set_error(ctx, "Unknown exception in SQL function");
+			}
+		}
+
+		template<typename F> void destroy(void* data) {
+			delete static_cast<F*>(data);
+		}
+
+		/**
+		 * Aggregates are default constructible types with Step(args...) and Final();
+		 * adding Value() and Inverse(args...) also makes them usable as window functions.
+		 * A fresh object is created for every group.
+		 */
+		template<typename T> concept Window = requires(const T& t) { t.Value(); } && requires { &T::Inverse; };
+
+		template<typename T> T* aggregate(sqlite3_context* ctx, const bool& create) {
+			void** slot = state_slot(ctx, create);
+			if (!slot)
+				return nullptr;
+			if (!*slot && create)
+				*slot = new T();
+			return static_cast<T*>(*slot);
+		}
+
+		template<typename T> void step(sqlite3_context* ctx, int, sqlite3_value** argv) {
+			try {
+				T* state = aggregate<T>(ctx, true);
+				if (!state)
+					throw std::bad_alloc();
+				std::apply([state](auto&&... args) { state->Step(std::forward<decltype(args)>(args)...); },
+					arguments<typename Traits<decltype(&T::Step)>::Arguments>(argv));
+			}
+			catch (const std::bad_alloc&) {
+				set_nomem(ctx);
+			}
+			catch (const std::exception& e) {
+				set_error(ctx, e.what());
+			}
+			catch (...) {
+				set_error(ctx, "Unknown exception in SQL function");
+			}
+		}
+
+		template<typename T> void inverse(sqlite3_context* ctx, int, sqlite3_value** argv) {
+			try {
+				T* state = aggregate<T>(ctx, true);
+				if (!state)
+					throw std::bad_alloc();
+				std::apply([state](auto&&... args) { state->Inverse(std::forward<decltype(args)>(args)...); },
+					arguments<typename Traits<decltype(&T::Inverse)>::Arguments>(argv));
+			}
+			catch (const std::bad_alloc&) {
+				set_nomem(ctx);
+			}
+			catch (const std::exception& e) {
+				set_error(ctx, e.what());
+			}
+			catch (...) {
+				set_error(ctx, "Unknown exception in SQL function");
+			}
+		}
+
+		template<typename T> void value(sqlite3_context* ctx) {
+			try {
+				T* state = aggregate<T>(ctx, false);
+				set_result(ctx, state ? state->Value() : T().Value());
+			}
+			catch (const std::bad_alloc&) {
+				set_nomem(ctx);
+			}
+			catch (const std::exception& e) {
+				set_error(ctx, e.what());
+			}
+			catch (...) {
+				set_error(ctx, "Unknown exception in SQL function");
+			}
+		}
+
+		template<typename T> void finalize(sqlite3_context* ctx) {
+			// Final is always called once per group, even after errors, so the state is released here
+			void** slot = state_slot(ctx, false);
+			std::unique_ptr<T> state(slot ? static_cast<T*>(*slot) : nullptr);
+			if (slot)
+				*slot = nullptr;
+			try {
+				set_result(ctx, state ? state->Final() : T().Final());
+			}
+			catch (const std::bad_alloc&) {
+				set_nomem(ctx);
+			}
+			catch (const std::exception& e) {
+				set_error(ctx, e.what());
+			}
+			catch (...) {
+				set_error(ctx, "Unknown exception in SQL function");
+			}
+		}
+	}
+#endif
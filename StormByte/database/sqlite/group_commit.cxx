@@ -0,0 +1,96 @@
+#include <StormByte/database/sqlite/exception.hxx>
+#include <StormByte/database/sqlite/group_commit.hxx>
+#include <StormByte/database/sqlite/sqlite3.hxx>
+#include <StormByte/database/sqlite/transaction.hxx>
+
+#include <sqlite3.h>
+
+using namespace StormByte::Database::SQLite;
+
+GroupCommit::GroupCommit(SQLite3& db, const std::chrono::milliseconds& window, const size_t& max_batch):
+m_database(db), m_window(window), m_max_batch(max_batch > 0 ? max_batch : 1), m_stop(false) {
+	m_committer = std::thread(&GroupCommit::run, this);
+}
+
+GroupCommit::~GroupCommit() noexcept {
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_stop = true;
+	}
+	m_cv.notify_all();
+	if (m_committer.joinable())
+		m_committer.join();
+}
+
+std::future<void> GroupCommit::submit(std::function<void()>&& work) {
+	std::promise<void> promise;
+	std::future<void> future = promise.get_future();
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_pending.emplace_back(std::move(work), std::move(promise));
+	}
+	m_cv.notify_all();
+	return future;
+}
+
+void GroupCommit::run() {
+	std::vector<Unit> batch;
+	while (true) {
+		std::unique_lock<std::mutex> lock(m_mutex);
+		m_cv.wait(lock, [this] { return m_stop || !m_pending.empty(); });
+		if (m_pending.empty())
+			break; // Stopped and everything was already committed
+
+		// The window opens with the first pending unit so a lone writer waits at most once
+		if (!m_stop && m_pending.size() < m_max_batch)
+			m_cv.wait_for(lock, m_window, [this] { return m_stop || m_pending.size() >= m_max_batch; });
+
+		while (!m_pending.empty() && batch.size() < m_max_batch) {
+			batch.push_back(std::move(m_pending.front()));
+			m_pending.pop_front();
+		}
+		lock.unlock();
+
+		commit(batch);
+		batch.clear();
+	}
+}
+
+void GroupCommit::commit(std::vector<Unit>& batch) {
+	// Waits for transactions of other threads to end and keeps their statements out of the group
+	std::lock_guard<std::recursive_mutex> lock(*m_database.m_transaction_mutex);
+	std::vector<bool> succeeded(batch.size(), false);
+	try {
+		// Inside a transaction begun with plain SQL the group would only be a savepoint its owner can still roll back
+		if (!sqlite3_get_autocommit(m_database.m_database))
+			throw QueryError("Group commit can not run inside a transaction begun with plain SQL");
+		Transaction transaction = m_database.transaction(Transaction::Mode::Immediate);
+		for (size_t i = 0; i < batch.size(); i++) {
+			try {
+				Transaction savepoint = transaction.Savepoint();
+				batch[i].first();
+				savepoint.Commit();
+				succeeded[i] = true;
+			}
+			catch (...) {
+				// Only this unit is rolled back, the rest of the group still commits
+				batch[i].second.set_exception(std::current_exception());
+			}
+		}
+		transaction.Commit();
+	}
+	catch (...) {
+		for (auto& unit: batch) {
+			try {
+				unit.second.set_exception(std::current_exception());
+			}
+			catch (const std::future_error&) {} // Unit already failed by itself
+		}
+		return;
+	}
+
+	for (size_t i = 0; i < batch.size(); i++) {
+		if (succeeded[i])
+			batch[i].second.set_value();
+	}
+}
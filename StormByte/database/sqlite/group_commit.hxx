@@ -0,0 +1,52 @@
+#pragma once
+
+#ifdef STORMBYTE_ENABLE_SQLITE
+	#include <StormByte/visibility.h>
+
+	#include <chrono>
+	#include <condition_variable>
+	#include <deque>
+	#include <functional>
+	#include <future>
+	#include <mutex>
+	#include <thread>
+	#include <utility>
+	#include <vector>
+
+	namespace StormByte::Database::SQLite {
+		class SQLite3;
+		/**
+		 * Runs logical transactions submitted from any thread on a single committer
+		 * thread. Every unit submitted within the window gets its own SAVEPOINT and
+		 * all of them share one physical COMMIT (and so one fsync). Transactions other
+		 * threads have open are waited for; a group only fails as a whole when it finds
+		 * one begun with plain SQL, which it can not wait for.
+		 */
+		class STORMBYTE_PRIVATE GroupCommit {
+			public:
+				GroupCommit(SQLite3&, const std::chrono::milliseconds&, const size_t&);
+				GroupCommit(const GroupCommit&)				= delete;
+				GroupCommit(GroupCommit&&)					= delete;
+				GroupCommit& operator=(const GroupCommit&)	= delete;
+				GroupCommit& operator=(GroupCommit&&)		= delete;
+				~GroupCommit() noexcept;
+
+				std::future<void> submit(std::function<void()>&&);
+
+			private:
+				using Unit = std::pair<std::function<void()>, std::promise<void>>;
+
+				void run();
+				void commit(std::vector<Unit>&);
+
+				SQLite3& m_database;
+				std::chrono::milliseconds m_window;
+				size_t m_max_batch;
+				std::deque<Unit> m_pending;
+				bool m_stop;
+				std::mutex m_mutex;
+				std::condition_variable m_cv;
+				std::thread m_committer;
+		};
+	}
+#endif
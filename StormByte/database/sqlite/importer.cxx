@@ -0,0 +1,349 @@
+#include <StormByte/database/sqlite/exception.hxx>
+#include <StormByte/database/sqlite/importer.hxx>
+
+#include <algorithm>
+#include <bit>
+#include <cerrno>
+#include <cstring>
+#include <limits>
+
+#ifdef LINUX
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#else
+#include <fstream>
+#include <sstream>
+#endif
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+using namespace StormByte::Database::SQLite;
+
+namespace {
+	// First of the three bytes in [p, end) or end, 16 bytes per comparison where SSE2 is there
+	const char* find(const char* p, const char* end, const char a, const char b, const char c) noexcept {
+		#ifdef __SSE2__
+		const __m128i va = _mm_set1_epi8(a), vb = _mm_set1_epi8(b), vc = _mm_set1_epi8(c);
+		for (; end - p >= 16; p += 16) {
+			const __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+			const __m128i hits = _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(chunk, va), _mm_cmpeq_epi8(chunk, vb)), _mm_cmpeq_epi8(chunk, vc));
+			const unsigned int mask = static_cast<unsigned int>(_mm_movemask_epi8(hits));
+			if (mask)
+				return p + std::countr_zero(mask);
+		}
+		#endif
+		for (; p < end; p++)
+			if (*p == a || *p == b || *p == c)
+				return p;
+		return end;
+	}
+
+	// Only canonical integers qualify, so binding them never changes what a TEXT column stores ("007" stays text)
+	bool integer(const char* p, const size_t& size, int64_t& value) noexcept {
+		const char* const end = p + size;
+		const bool negative = p < end && *p == '-';
+		if (negative)
+			p++;
+		const size_t digits = static_cast<size_t>(end - p);
+		if (digits == 0 || digits > 18 || (*p == '0' && (digits > 1 || negative)))
+			return false;
+		int64_t result = 0;
+		for (; p < end; p++) {
+			if (static_cast<unsigned char>(*p - '0') > 9)
+				return false;
+			result = result * 10 + (*p - '0');
+		}
+		value = negative ? -result : result;
+		return true;
+	}
+}
+
+Importer::Importer(const std::filesystem::path& file, const ImportOptions& options):m_options(options),
+#ifdef LINUX
+m_map(nullptr),
+#endif
+m_data(nullptr), m_end(nullptr), m_position(nullptr), m_columns(0),
+m_claimed(0), m_taken(0), m_blocks(std::numeric_limits<size_t>::max()), m_stop(false) {
+	if (m_options.delimiter == '\n' || m_options.delimiter == '\r' || (m_options.quote != '\0' && m_options.quote == m_options.delimiter))
+		throw Exception("Invalid delimiter for " + file.string());
+
+	#ifdef LINUX
+	const int fd = open(file.c_str(), O_RDONLY | O_CLOEXEC);
+	struct stat status;
+	if (fd < 0 || fstat(fd, &status) != 0) {
+		const std::string error = std::strerror(errno);
+		if (fd >= 0)
+			close(fd);
+		throw Exception("Cannot open " + file.string() + ": " + error);
+	}
+	const size_t length = static_cast<size_t>(status.st_size);
+	if (length > 0) {
+		void* map = mmap(nullptr, length, PROT_READ, MAP_PRIVATE, fd, 0);
+		if (map == MAP_FAILED) {
+			const std::string error = std::strerror(errno);
+			close(fd);
+			throw Exception("Cannot map " + file.string() + ": " + error);
+		}
+		madvise(map, length, MADV_SEQUENTIAL);
+		m_map = map;
+		m_data = static_cast<const char*>(map);
+	}
+	close(fd);
+	#else
+	std::ifstream stream(file, std::ios::binary);
+	if (!stream)
+		throw Exception("Cannot open " + file.string());
+	std::ostringstream contents;
+	contents << stream.rdbuf();
+	m_contents = std::move(contents).str();
+	m_data = m_contents.data();
+	const size_t length = m_contents.size();
+	#endif
+	m_end = m_data + length;
+	m_position = m_data;
+	if (length >= 3 && std::memcmp(m_data, "\xEF\xBB\xBF", 3) == 0)
+		m_position += 3;
+
+	try {
+		Block first;
+		const char* position = m_position;
+		while (first.rows == 0 && position < m_end)
+			position = record(position, &first);
+		if (m_options.header) {
+			m_position = position;
+			for (const Field& field: first.fields)
+				m_names.push_back(field.data ? std::string(field.data, field.size) : first.unescaped.substr(static_cast<size_t>(field.integer), field.size));
+		}
+		if (!m_options.columns.empty())
+			m_names = m_options.columns;
+		m_columns = m_names.empty() ? first.fields.size() : m_names.size();
+	}
+	catch (...) {
+		stop();
+		throw;
+	}
+
+	for (unsigned int i = 0; i < m_options.parsers && m_columns > 0; i++)
+		m_parsers.emplace_back(&Importer::run, this);
+}
+
+Importer::~Importer() noexcept {
+	stop();
+}
+
+const std::vector<std::string>& Importer::names() const noexcept {
+	return m_names;
+}
+
+size_t Importer::columns() const noexcept {
+	return m_columns;
+}
+
+size_t Importer::size() const noexcept {
+	return static_cast<size_t>(m_end - m_data);
+}
+
+std::unique_ptr<Importer::Block> Importer::next() {
+	if (m_columns == 0)
+		return nullptr;
+
+	if (m_parsers.empty()) {
+		if (m_position >= m_end)
+			return nullptr;
+		return parse(m_position, std::min(m_position + BLOCK_SIZE, m_end));
+	}
+
+	std::unique_lock<std::mutex> lock(m_mutex);
+	m_cv.wait(lock, [this] { return m_ready.count(m_taken) > 0 || m_taken == m_blocks; });
+	auto it = m_ready.find(m_taken);
+	if (it == m_ready.end())
+		return nullptr;
+	std::unique_ptr<Block> block = std::move(it->second);
+	m_ready.erase(it);
+	m_taken++;
+	lock.unlock();
+	m_cv.notify_all();
+	return block;
+}
+
+void Importer::recycle(std::unique_ptr<Block>&& block) noexcept {
+	block->fields.clear();
+	block->rows = 0;
+	block->unescaped.clear();
+	block->error = nullptr;
+	std::lock_guard<std::mutex> lock(m_mutex);
+	if (m_spare.size() <= m_parsers.size())
+		m_spare.push_back(std::move(block));
+}
+
+const char* Importer::record(const char* p, Block* block) const {
+	const char delimiter = m_options.delimiter, quote = m_options.quote;
+	const char* const start = p;
+	size_t fields = 0;
+	bool quoted = false;
+	for (;;) {
+		Field field { p, 0, 0, Kind::Text };
+		quoted = quote != '\0' && p < m_end && *p == quote;
+		if (quoted) {
+			// Runs until a quote that is not doubled, newlines included
+			const char* const begin = ++p;
+			bool escaped = false;
+			for (;;) {
+				const char* closing = static_cast<const char*>(std::memchr(p, quote, static_cast<size_t>(m_end - p)));
+				if (!closing)
+					throw Exception("Unterminated quoted field at byte " + std::to_string(begin - 1 - m_data));
+				p = closing + 1;
+				if (p < m_end && *p == quote) {
+					escaped = true;
+					p++;
+					continue;
+				}
+				field.data = begin;
+				field.size = static_cast<size_t>(closing - begin);
+				break;
+			}
+			if (p < m_end && *p != delimiter && *p != '\n' && *p != '\r')
+				throw Exception("Unexpected character after quoted field at byte " + std::to_string(p - m_data));
+			if (block && escaped) {
+				field.integer = static_cast<int64_t>(block->unescaped.size());
+				for (const char* q = field.data; q < field.data + field.size; q++) {
+					block->unescaped.push_back(*q);
+					if (*q == quote)
+						q++;
+				}
+				field.size = block->unescaped.size() - static_cast<size_t>(field.integer);
+				field.data = nullptr; // Pointed into unescaped once the block is complete
+			}
+		}
+		else {
+			p = find(p, m_end, delimiter, '\n', '\r');
+			field.size = static_cast<size_t>(p - field.data);
+			if (block) {
+				if (field.size == 0 && m_options.empty_as_null)
+					field.kind = Kind::Null;
+				else if (integer(field.data, field.size, field.integer))
+					field.kind = Kind::Integer;
+			}
+		}
+		fields++;
+		if (block)
+			block->fields.push_back(field);
+
+		if (p < m_end && *p == delimiter) {
+			p++;
+			continue;
+		}
+		if (p < m_end && *p == '\r')
+			p++;
+		if (p < m_end && *p == '\n')
+			p++;
+		break;
+	}
+
+	if (!block)
+		return p;
+	// Blank lines are skipped
+	if (fields == 1 && !quoted && p - start <= 2 && block->fields.back().size == 0) {
+		block->fields.pop_back();
+		return p;
+	}
+	if (m_columns > 0 && fields != m_columns)
+		throw Exception("Record at byte " + std::to_string(start - m_data) + " has " + std::to_string(fields) + " fields, " + std::to_string(m_columns) + " expected");
+	block->rows++;
+	return p;
+}
+
+std::unique_ptr<Importer::Block> Importer::parse(const char*& position, const char* limit) {
+	std::unique_ptr<Block> block;
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		if (!m_spare.empty()) {
+			block = std::move(m_spare.back());
+			m_spare.pop_back();
+		}
+	}
+	if (!block)
+		block = std::make_unique<Block>();
+	try {
+		while (position < limit)
+			position = record(position, block.get());
+	}
+	catch (...) {
+		block->error = std::current_exception();
+		position = m_end;
+	}
+	for (Field& field: block->fields)
+		if (!field.data && field.kind == Kind::Text)
+			field.data = block->unescaped.data() + field.integer;
+	return block;
+}
+
+void Importer::run() noexcept {
+	for (;;) {
+		size_t index = 0;
+		{
+			std::unique_lock<std::mutex> lock(m_mutex);
+			// Bounded read ahead, the writer is the bottleneck and parsed blocks are several times their text
+			m_cv.wait(lock, [this] { return m_stop || m_claimed - m_taken < 2 * m_parsers.size(); });
+			if (m_stop)
+				return;
+		}
+
+		std::unique_ptr<Block> block;
+		const char *begin, *end;
+		{
+			// Where a record starts depends on the quotes before it, so blocks are split one after another
+			std::lock_guard<std::mutex> split_lock(m_split_mutex);
+			{
+				std::lock_guard<std::mutex> lock(m_mutex);
+				if (m_position >= m_end) {
+					m_blocks = m_claimed;
+					m_cv.notify_all();
+					return;
+				}
+				index = m_claimed++;
+			}
+			begin = end = m_position;
+			const char* const limit = std::min(begin + BLOCK_SIZE, m_end);
+			try {
+				while (end < limit)
+					end = record(end, nullptr);
+				m_position = end;
+			}
+			catch (...) {
+				// Parsing the block again stops right at the failing record
+				m_position = m_end;
+				end = m_end;
+			}
+		}
+
+		block = parse(begin, end);
+		{
+			std::lock_guard<std::mutex> lock(m_mutex);
+			if (block->error)
+				m_stop = true;
+			m_ready[index] = std::move(block);
+		}
+		m_cv.notify_all();
+	}
+}
+
+void Importer::stop() noexcept {
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_stop = true;
+	}
+	m_cv.notify_all();
+	for (std::thread& parser: m_parsers)
+		parser.join();
+	m_parsers.clear();
+	#ifdef LINUX
+	if (m_map)
+		munmap(m_map, size());
+	m_map = nullptr;
+	#endif
+}
@@ -0,0 +1,106 @@
+#pragma once
+
+#ifdef STORMBYTE_ENABLE_SQLITE
+	#include <StormByte/visibility.h>
+
+	#include <chrono>
+	#include <condition_variable>
+	#include <cstdint>
+	#include <exception>
+	#include <filesystem>
+	#include <map>
+	#include <memory>
+	#include <mutex>
+	#include <string>
+	#include <thread>
+	#include <vector>
+
+	namespace StormByte::Database::SQLite {
+		struct STORMBYTE_PUBLIC ImportOptions {
+			char delimiter						= ',';		// '\t' for TSV
+			char quote							= '"';		// '\0' when fields are never quoted
+			bool header							= true;		// The first record names the columns and is not loaded
+			std::vector<std::string> columns;				// Target columns, empty uses the header or the table's own order
+			bool empty_as_null					= false;	// Empty unquoted fields are bound as NULL instead of ''
+			size_t rows_per_transaction			= 100000;	// 0 loads the whole file in a single transaction
+			unsigned int parsers				= 0;		// Threads parsing ahead of the writer, 0 parses on the calling thread
+		};
+
+		struct STORMBYTE_PUBLIC ImportStatistics {
+			uint64_t rows						= 0;
+			uint64_t transactions				= 0;		// Chunks committed (savepoints when already in a transaction)
+			uint64_t bytes						= 0;		// Size of the file
+			std::chrono::milliseconds duration	{ 0 };
+		};
+
+		/**
+		 * Splits a memory mapped delimited file into records without copying:
+		 * unquoted fields point straight into the mapping, only quoted fields with
+		 * doubled quotes are unescaped. Records are handed out in blocks, parsed
+		 * either on demand or ahead of time by parser threads, always in file order.
+		 */
+		class STORMBYTE_PRIVATE Importer {
+			public:
+				enum class Kind: unsigned char { Null = 0, Integer, Text };
+				struct Field {
+					const char* data;
+					size_t size;
+					int64_t integer;
+					Kind kind;
+				};
+				struct Block {
+					std::vector<Field> fields;	// columns() fields per record
+					size_t rows = 0;
+					std::string unescaped;		// Storage for fields that needed unescaping
+					std::exception_ptr error;	// The record that could not be parsed, rows are the ones before it
+				};
+
+				static constexpr size_t BLOCK_SIZE = 4 * 1024 * 1024;
+
+				Importer(const std::filesystem::path&, const ImportOptions&);
+				Importer(const Importer&)				= delete;
+				Importer(Importer&&)					= delete;
+				Importer& operator=(const Importer&)	= delete;
+				Importer& operator=(Importer&&)			= delete;
+				~Importer() noexcept;
+
+				// The header or the configured columns, empty when none are known
+				const std::vector<std::string>& names() const noexcept;
+				size_t columns() const noexcept;
+				size_t size() const noexcept;
+				// nullptr once the whole file was read, nothing follows a block with an error
+				std::unique_ptr<Block> next();
+				// Hands a consumed block back so its buffers are reused instead of faulted in again
+				void recycle(std::unique_ptr<Block>&&) noexcept;
+
+			private:
+				// Parses the record starting there and returns where the next one starts, without a block it only skips it
+				const char* record(const char*, Block*) const;
+				// Whole records from the position until it passes the limit
+				std::unique_ptr<Block> parse(const char*&, const char*);
+				void run() noexcept;
+				void stop() noexcept;
+
+				ImportOptions m_options;
+				#ifdef LINUX
+				void* m_map;
+				#else
+				std::string m_contents;
+				#endif
+				const char* m_data;
+				const char* m_end;
+				const char* m_position;
+				std::vector<std::string> m_names;
+				size_t m_columns;
+
+				// Parser threads claim blocks in order and the writer takes them back in that order
+				std::vector<std::thread> m_parsers;
+				std::map<size_t, std::unique_ptr<Block>> m_ready;
+				std::vector<std::unique_ptr<Block>> m_spare;
+				size_t m_claimed, m_taken, m_blocks;
+				bool m_stop;
+				std::mutex m_split_mutex, m_mutex;
+				std::condition_variable m_cv;
+		};
+	}
+#endif
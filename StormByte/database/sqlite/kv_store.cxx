@@ -0,0 +1,361 @@
+#include <StormByte/database/sqlite/exception.hxx>
+#include <StormByte/database/sqlite/kv_store.hxx>
+#include <StormByte/database/sqlite/prepared_stmt.hxx>
+
+#include <algorithm>
+#include <list>
+#include <sqlite3.h>
+
+using namespace StormByte::Database::SQLite;
+
+namespace StormByte::Database::SQLite {
+	// LRU split in independently locked shards, so concurrent readers rarely wait on each other
+	class KVCache {
+		public:
+			KVCache(const size_t& entries, const size_t& shards):m_shards(std::max<size_t>(shards, 1)) {
+				for (Shard& shard: m_shards)
+					shard.capacity = std::max<size_t>(entries / m_shards.size(), 1);
+			}
+
+			// A hit with nullopt means the key is known not to exist
+			bool get(const std::string_view& key, std::optional<std::string>& value) {
+				Shard& shard = shard_of(key);
+				std::lock_guard<std::mutex> lock(shard.mutex);
+				auto it = shard.entries.find(key);
+				if (it == shard.entries.end()) {
+					shard.misses++;
+					return false;
+				}
+				shard.lru.splice(shard.lru.begin(), shard.lru, it->second.lru);
+				value = it->second.value;
+				shard.hits++;
+				return true;
+			}
+
+			uint64_t generation(const std::string_view& key) {
+				Shard& shard = shard_of(key);
+				std::lock_guard<std::mutex> lock(shard.mutex);
+				return shard.generation;
+			}
+
+			// Result of a database read, dropped if the shard was written to since the read started
+			void fill(const std::string_view& key, const std::optional<std::string>& value, const uint64_t& generation) {
+				Shard& shard = shard_of(key);
+				std::lock_guard<std::mutex> lock(shard.mutex);
+				if (shard.generation == generation)
+					set(shard, key, value);
+			}
+
+			void update(const std::string_view& key, const std::optional<std::string>& value) {
+				Shard& shard = shard_of(key);
+				std::lock_guard<std::mutex> lock(shard.mutex);
+				shard.generation++;
+				set(shard, key, value);
+			}
+
+			void statistics(uint64_t& hits, uint64_t& misses) {
+				for (Shard& shard: m_shards) {
+					std::lock_guard<std::mutex> lock(shard.mutex);
+					hits += shard.hits;
+					misses += shard.misses;
+				}
+			}
+
+		private:
+			struct KeyHash {
+				using is_transparent = void;
+				size_t operator()(const std::string_view& key) const noexcept { return std::hash<std::string_view>()(key); }
+			};
+			struct Entry {
+				std::optional<std::string> value;
+				std::list<const std::string*>::iterator lru;
+			};
+			struct Shard {
+				std::mutex mutex;
+				std::unordered_map<std::string, Entry, KeyHash, std::equal_to<>> entries;
+				std::list<const std::string*> lru; // Most recently used first, pointing at the map's keys
+				size_t capacity = 1;
+				uint64_t generation = 0, hits = 0, misses = 0;
+			};
+
+			Shard& shard_of(const std::string_view& key) noexcept {
+				// The map buckets with the low bits, shards take the high ones of the hash spread over 64 bits
+				const uint64_t hash = static_cast<uint64_t>(KeyHash()(key)) * 0x9E3779B97F4A7C15ull;
+				return m_shards[static_cast<size_t>(hash >> 32) % m_shards.size()];
+			}
+
+			void set(Shard& shard, const std::string_view& key, const std::optional<std::string>& value) {
+				auto it = shard.entries.find(key);
+				if (it != shard.entries.end()) {
+					it->second.value = value;
+					shard.lru.splice(shard.lru.begin(), shard.lru, it->second.lru);
+					return;
+				}
+				if (shard.entries.size() >= shard.capacity) {
+					shard.entries.erase(shard.entries.find(*shard.lru.back()));
+					shard.lru.pop_back();
+				}
+				it = shard.entries.emplace(std::string(key), Entry { value, {} }).first;
+				shard.lru.push_front(&it->first);
+				it->second.lru = shard.lru.begin();
+			}
+
+			std::vector<Shard> m_shards;
+	};
+}
+
+namespace {
+	std::string identifier(const std::string& name) {
+		std::string quoted = "\"";
+		for (const char& c: name) {
+			quoted += c;
+			if (c == '"')
+				quoted += c;
+		}
+		return quoted + "\"";
+	}
+
+	void bind_blob(sqlite3_stmt* stmt, const int& index, const std::string_view& data) noexcept {
+		// Caller's memory stays valid until the statement is reset, and a zero length blob is not NULL
+		sqlite3_bind_blob64(stmt, index, data.empty() ? "" : data.data(), data.size(), SQLITE_STATIC);
+	}
+
+	std::string column(sqlite3_stmt* stmt, const int& index) {
+		const char* data = static_cast<const char*>(sqlite3_column_blob(stmt, index));
+		return std::string(data ? data : "", static_cast<size_t>(sqlite3_column_bytes(stmt, index)));
+	}
+}
+
+KVStore::KVStore(const std::filesystem::path& file, const KVStoreOptions& options):SQLite3(file), m_options(options), m_stop(false) {
+	init_database(m_options.profile);
+	const std::string table = identifier(m_options.table);
+	silent_query("CREATE TABLE IF NOT EXISTS " + table + "(key BLOB PRIMARY KEY NOT NULL, value BLOB NOT NULL) WITHOUT ROWID");
+	m_get		= prepare_sentence("kv.get", "SELECT value FROM " + table + " WHERE key = ?");
+	m_put		= prepare_sentence("kv.put", "INSERT OR REPLACE INTO " + table + "(key, value) VALUES (?, ?)");
+	m_delete	= prepare_sentence("kv.delete", "DELETE FROM " + table + " WHERE key = ?");
+	m_scan		= prepare_sentence("kv.scan", "SELECT key, value FROM " + table + " WHERE key >= ?1 AND key < ?2 ORDER BY key LIMIT ?3");
+	m_scan_all	= prepare_sentence("kv.scan_all", "SELECT key, value FROM " + table + " WHERE key >= ?1 ORDER BY key LIMIT ?2");
+	if (m_options.cache_entries > 0)
+		m_cache = std::make_unique<KVCache>(m_options.cache_entries, m_options.cache_shards);
+	if (m_options.flush_interval.count() > 0)
+		m_flusher = std::thread(&KVStore::run, this);
+}
+
+KVStore::~KVStore() noexcept {
+	{
+		std::lock_guard<std::mutex> lock(m_buffer_mutex);
+		m_stop = true;
+	}
+	m_cv.notify_all();
+	if (m_flusher.joinable())
+		m_flusher.join();
+	// A failure is often transient (a busy database), every attempt retries all the buffered writes
+	for (unsigned int attempt = 0; attempt < FLUSH_ATTEMPTS; attempt++) {
+		try {
+			Flush();
+			return;
+		}
+		catch (...) {
+			std::this_thread::sleep_for(std::max(m_options.flush_interval, std::chrono::milliseconds(10)));
+		}
+	}
+}
+
+std::optional<std::string> KVStore::Get(const std::string_view& key) {
+	{
+		std::lock_guard<std::mutex> lock(m_buffer_mutex);
+		auto it = m_pending.find(key);
+		if (it != m_pending.end())
+			return it->second;
+		it = m_flushing.find(key);
+		if (it != m_flushing.end())
+			return it->second;
+	}
+
+	std::optional<std::string> value;
+	if (m_cache && m_cache->get(key, value))
+		return value;
+	const uint64_t generation = m_cache ? m_cache->generation(key) : 0;
+	{
+		std::lock_guard<std::mutex> lock(m_database_mutex);
+		value = read(key);
+	}
+	if (m_cache)
+		m_cache->fill(key, value, generation);
+	return value;
+}
+
+std::vector<std::optional<std::string>> KVStore::MultiGet(const std::vector<std::string>& keys) {
+	std::vector<std::optional<std::string>> values(keys.size());
+	std::vector<size_t> missing;
+	{
+		std::lock_guard<std::mutex> lock(m_buffer_mutex);
+		for (size_t i = 0; i < keys.size(); i++) {
+			auto it = m_pending.find(keys[i]);
+			if (it == m_pending.end() && (it = m_flushing.find(keys[i])) == m_flushing.end())
+				missing.push_back(i);
+			else
+				values[i] = it->second;
+		}
+	}
+	if (m_cache)
+		missing.erase(std::remove_if(missing.begin(), missing.end(), [&](const size_t& i) { return m_cache->get(keys[i], values[i]); }), missing.end());
+	if (missing.empty())
+		return values;
+
+	std::vector<uint64_t> generations;
+	if (m_cache)
+		for (const size_t& i: missing)
+			generations.push_back(m_cache->generation(keys[i]));
+	{
+		// One read transaction, so every key comes from the same snapshot
+		std::lock_guard<std::mutex> lock(m_database_mutex);
+		Transaction snapshot = transaction();
+		for (const size_t& i: missing)
+			values[i] = read(keys[i]);
+		snapshot.Commit();
+	}
+	if (m_cache)
+		for (size_t j = 0; j < missing.size(); j++)
+			m_cache->fill(keys[missing[j]], values[missing[j]], generations[j]);
+	return values;
+}
+
+void KVStore::Put(const std::string_view& key, const std::string_view& value) {
+	write(key, std::string(value));
+}
+
+void KVStore::Delete(const std::string_view& key) {
+	write(key, std::nullopt);
+}
+
+std::vector<std::pair<std::string, std::string>> KVStore::Scan(const std::string_view& prefix, const size_t& limit) {
+	Flush();
+	// Keys starting with the prefix sort before the prefix with its last byte below 0xFF incremented
+	std::string upper(prefix);
+	while (!upper.empty() && static_cast<unsigned char>(upper.back()) == 0xFF)
+		upper.pop_back();
+	if (!upper.empty())
+		upper.back() = static_cast<char>(static_cast<unsigned char>(upper.back()) + 1);
+
+	std::vector<std::pair<std::string, std::string>> pairs;
+	std::lock_guard<std::mutex> lock(m_database_mutex);
+	PreparedSTMT& scan = upper.empty() ? *m_scan_all : *m_scan;
+	sqlite3_stmt* stmt = scan.m_stmt;
+	bind_blob(stmt, 1, prefix);
+	if (!upper.empty())
+		bind_blob(stmt, 2, upper);
+	sqlite3_bind_int64(stmt, upper.empty() ? 2 : 3, limit > 0 ? static_cast<sqlite3_int64>(limit) : -1);
+	int rc;
+	while ((rc = scan.step()) == SQLITE_ROW)
+		pairs.emplace_back(column(stmt, 0), column(stmt, 1));
+	sqlite3_reset(stmt);
+	sqlite3_clear_bindings(stmt);
+	if (rc != SQLITE_DONE)
+		scan.throw_error(rc);
+	return pairs;
+}
+
+void KVStore::Flush() {
+	std::lock_guard<std::mutex> flush_lock(m_flush_mutex);
+	commit();
+}
+
+void KVStore::commit() {
+	{
+		std::lock_guard<std::mutex> lock(m_buffer_mutex);
+		if (m_pending.empty())
+			return;
+		m_flushing.swap(m_pending);
+	}
+
+	try {
+		std::lock_guard<std::mutex> lock(m_database_mutex);
+		Transaction batch = transaction(Transaction::Mode::Immediate);
+		for (const auto& write: m_flushing) {
+			PreparedSTMT& stmt = write.second ? *m_put : *m_delete;
+			bind_blob(stmt.m_stmt, 1, write.first);
+			if (write.second)
+				bind_blob(stmt.m_stmt, 2, *write.second);
+			const int rc = stmt.step();
+			sqlite3_reset(stmt.m_stmt);
+			sqlite3_clear_bindings(stmt.m_stmt);
+			if (rc != SQLITE_DONE)
+				stmt.throw_error(rc);
+		}
+		batch.Commit();
+	}
+	catch (...) {
+		// Back in the buffer for the next attempt, writes made meanwhile are newer and win
+		std::lock_guard<std::mutex> lock(m_buffer_mutex);
+		m_pending.merge(m_flushing);
+		m_flushing.clear();
+		m_statistics.failed_flushes++;
+		throw;
+	}
+
+	std::lock_guard<std::mutex> lock(m_buffer_mutex);
+	m_statistics.flushes++;
+	m_statistics.flushed_writes += m_flushing.size();
+	m_flushing.clear();
+}
+
+KVStoreStatistics KVStore::Statistics() const {
+	KVStoreStatistics statistics;
+	{
+		std::lock_guard<std::mutex> lock(m_buffer_mutex);
+		statistics = m_statistics;
+		statistics.pending = m_pending.size();
+	}
+	if (m_cache)
+		m_cache->statistics(statistics.cache_hits, statistics.cache_misses);
+	return statistics;
+}
+
+void KVStore::write(const std::string_view& key, std::optional<std::string>&& value) {
+	if (m_cache)
+		m_cache->update(key, value);
+	size_t pending;
+	{
+		std::lock_guard<std::mutex> lock(m_buffer_mutex);
+		auto it = m_pending.find(key);
+		if (it != m_pending.end())
+			it->second = std::move(value);
+		else
+			m_pending.emplace(std::string(key), std::move(value));
+		pending = m_pending.size();
+	}
+	if (pending >= m_options.batch_size)
+		Flush();
+}
+
+std::optional<std::string> KVStore::read(const std::string_view& key) {
+	sqlite3_stmt* stmt = m_get->m_stmt;
+	bind_blob(stmt, 1, key);
+	std::optional<std::string> value;
+	int rc;
+	if ((rc = m_get->step()) == SQLITE_ROW) {
+		value = column(stmt, 0);
+		rc = SQLITE_DONE;
+	}
+	sqlite3_reset(stmt);
+	sqlite3_clear_bindings(stmt);
+	if (rc != SQLITE_DONE)
+		m_get->throw_error(rc);
+	return value;
+}
+
+void KVStore::run() noexcept {
+	std::unique_lock<std::mutex> lock(m_buffer_mutex);
+	while (!m_cv.wait_for(lock, m_options.flush_interval, [this] { return m_stop; })) {
+		if (m_pending.empty())
+			continue;
+		lock.unlock();
+		// A failure leaves the writes buffered, the next interval or Flush retries them
+		try {
+			Flush();
+		}
+		catch (...) {}
+		lock.lock();
+	}
+}
@@ -0,0 +1,97 @@
+#pragma once
+
+#ifdef STORMBYTE_ENABLE_SQLITE
+	#include <StormByte/database/sqlite/sqlite3.hxx>
+
+	#include <chrono>
+	#include <condition_variable>
+	#include <cstdint>
+	#include <filesystem>
+	#include <functional>
+	#include <memory>
+	#include <mutex>
+	#include <optional>
+	#include <string>
+	#include <string_view>
+	#include <thread>
+	#include <unordered_map>
+	#include <utility>
+	#include <vector>
+
+	namespace StormByte::Database::SQLite {
+		class KVCache;
+
+		struct STORMBYTE_PUBLIC KVStoreOptions {
+			std::string table							= "kv";
+			Profile profile								= Profile::WriteHeavy;
+			size_t cache_entries						= 65536;	// 0 disables the read cache
+			size_t cache_shards							= 16;
+			size_t batch_size							= 1024;		// Buffered writes that make the writer flush them
+			std::chrono::milliseconds flush_interval	{ 50 };		// Oldest a buffered write gets, 0 only flushes on size or Flush
+		};
+
+		struct STORMBYTE_PUBLIC KVStoreStatistics {
+			uint64_t cache_hits			= 0;
+			uint64_t cache_misses		= 0;
+			uint64_t flushes			= 0;	// Transactions committed
+			uint64_t flushed_writes		= 0;	// Puts and deletes in them, repeated writes to a key count once
+			uint64_t failed_flushes		= 0;	// Their writes stay buffered for the next attempt
+			size_t pending				= 0;	// Writes waiting for the next flush
+		};
+
+		/**
+		 * Key value store over a WITHOUT ROWID table of blobs. Writes are buffered
+		 * and committed together, in one transaction, once enough of them pile up
+		 * or the flush interval passes; reads see buffered writes right away and
+		 * are served from a sharded LRU cache (negative results included) before
+		 * touching the database. Thread safe. Writes buffered when the process
+		 * dies are lost, Flush makes them durable.
+		 */
+		class STORMBYTE_PUBLIC KVStore final: public SQLite3 {
+			public:
+				KVStore(const std::filesystem::path&, const KVStoreOptions& = {});
+				KVStore(const KVStore&)					= delete;
+				KVStore(KVStore&&)						= delete;
+				KVStore& operator=(const KVStore&)		= delete;
+				KVStore& operator=(KVStore&&)			= delete;
+				~KVStore() noexcept override; // Flushes what is still buffered
+
+				std::optional<std::string>					Get(const std::string_view&);
+				std::vector<std::optional<std::string>>		MultiGet(const std::vector<std::string>&);
+				void										Put(const std::string_view&, const std::string_view&);
+				void										Delete(const std::string_view&);
+				// Key ordered pairs whose key starts with the prefix, buffered writes are flushed first; 0 means no limit
+				std::vector<std::pair<std::string, std::string>>	Scan(const std::string_view&, const size_t& = 0);
+				// Commits every buffered write, including those a failed background flush put back
+				void										Flush();
+				KVStoreStatistics							Statistics() const;
+
+			private:
+				struct KeyHash {
+					using is_transparent = void;
+					size_t operator()(const std::string_view& key) const noexcept { return std::hash<std::string_view>()(key); }
+				};
+				static constexpr unsigned int FLUSH_ATTEMPTS = 3; // By the destructor
+
+				using Writes = std::unordered_map<std::string, std::optional<std::string>, KeyHash, std::equal_to<>>; // nullopt deletes
+
+				void post_init_action() noexcept override {}
+				void write(const std::string_view&, std::optional<std::string>&&);
+				std::optional<std::string> read(const std::string_view&); // Holding the database mutex
+				void commit(); // Holding the flush mutex
+				void run() noexcept;
+
+				KVStoreOptions m_options;
+				std::shared_ptr<PreparedSTMT> m_get, m_put, m_delete, m_scan, m_scan_all;
+				std::unique_ptr<KVCache> m_cache;
+				Writes m_pending, m_flushing; // Buffered and being committed, in that order of precedence
+				KVStoreStatistics m_statistics;
+				bool m_stop;
+				mutable std::mutex m_buffer_mutex;		// Buffers and statistics
+				std::mutex m_flush_mutex;				// One flush at a time
+				std::mutex m_database_mutex;			// The connection and its statements
+				std::condition_variable m_cv;
+				std::thread m_flusher;
+		};
+	}
+#endif
@@ -0,0 +1,202 @@
+#include <StormByte/database/sqlite/exception.hxx>
+#include <StormByte/database/sqlite/memory.hxx>
+
+#include <algorithm>
+#include <bit>
+#include <cstdlib>
+#include <cstring>
+#include <mutex>
+#include <sqlite3.h>
+
+using namespace StormByte::Database::SQLite;
+
+namespace {
+	// Every chunk starts with its header, which keeps the returned memory 8 byte aligned as SQLite requires
+	struct Header {
+		uint32_t size_class;
+		uint32_t size; // Usable bytes
+	};
+	constexpr size_t HEADER = sizeof(Header);
+	static_assert(HEADER == 8);
+
+	// Power of two chunks from 32 bytes to 64KiB, larger requests are rare and go to the system allocator
+	constexpr unsigned int MIN_SHIFT = 5, MAX_SHIFT = 16;
+	constexpr uint32_t CLASSES = MAX_SHIFT - MIN_SHIFT + 1;
+	constexpr uint32_t SYSTEM = CLASSES;
+
+	struct Pool {
+		std::mutex mutex;
+		char* arena = nullptr;
+		size_t reserved = 0, next = 0;
+		Header* free[CLASSES] = {};
+		char* pages = nullptr;
+		bool installed = false;
+		size_t used = 0, high_water = 0, allocations = 0, overflow = 0;
+	};
+	Pool pool;
+
+	unsigned int shift_of(const size_t& chunk) noexcept {
+		return std::max(MIN_SHIFT, static_cast<unsigned int>(std::bit_width(chunk - 1)));
+	}
+
+	// Free chunks keep the next free chunk of their class where the user data was
+	Header*& next_free(Header* header) noexcept {
+		return *reinterpret_cast<Header**>(header + 1);
+	}
+
+	void* pool_malloc(int n) noexcept {
+		const size_t size = static_cast<size_t>(std::max(n, 1));
+		Header* header = nullptr;
+		std::lock_guard<std::mutex> lock(pool.mutex);
+		if (size + HEADER <= (size_t(1) << MAX_SHIFT)) {
+			const unsigned int shift = shift_of(size + HEADER);
+			const uint32_t size_class = shift - MIN_SHIFT;
+			const size_t chunk = size_t(1) << shift;
+			if (pool.free[size_class]) {
+				header = pool.free[size_class];
+				pool.free[size_class] = next_free(header);
+			}
+			else if (pool.reserved - pool.next >= chunk) {
+				header = reinterpret_cast<Header*>(pool.arena + pool.next);
+				pool.next += chunk;
+				header->size_class = size_class;
+				header->size = static_cast<uint32_t>(chunk - HEADER);
+			}
+		}
+		if (!header) {
+			const size_t rounded = (size + 7) & ~size_t(7);
+			header = static_cast<Header*>(std::malloc(rounded + HEADER));
+			if (!header)
+				return nullptr;
+			header->size_class = SYSTEM;
+			header->size = static_cast<uint32_t>(rounded);
+			pool.overflow++;
+		}
+		pool.used += header->size;
+		pool.high_water = std::max(pool.high_water, pool.used);
+		pool.allocations++;
+		return header + 1;
+	}
+
+	void pool_free(void* p) noexcept {
+		if (!p)
+			return;
+		Header* header = static_cast<Header*>(p) - 1;
+		std::lock_guard<std::mutex> lock(pool.mutex);
+		pool.used -= header->size;
+		pool.allocations--;
+		if (header->size_class == SYSTEM)
+			std::free(header);
+		else {
+			next_free(header) = pool.free[header->size_class];
+			pool.free[header->size_class] = header;
+		}
+	}
+
+	int pool_size(void* p) noexcept {
+		return static_cast<int>((static_cast<Header*>(p) - 1)->size);
+	}
+
+	void* pool_realloc(void* p, int n) noexcept {
+		if (n <= pool_size(p))
+			return p;
+		void* moved = pool_malloc(n);
+		if (moved) {
+			std::memcpy(moved, p, static_cast<size_t>(pool_size(p)));
+			pool_free(p);
+		}
+		return moved;
+	}
+
+	int pool_roundup(int n) noexcept {
+		const size_t size = static_cast<size_t>(std::max(n, 1));
+		if (size + HEADER <= (size_t(1) << MAX_SHIFT))
+			return static_cast<int>((size_t(1) << shift_of(size + HEADER)) - HEADER);
+		return static_cast<int>((size + 7) & ~size_t(7));
+	}
+
+	int pool_init(void*) noexcept { return SQLITE_OK; }
+
+	void pool_shutdown(void*) noexcept {}
+
+	void check(const int& rc, const char* what) {
+		if (rc != SQLITE_OK)
+			throw Exception(std::string("Can not configure SQLite ") + what + ": " + sqlite3_errstr(rc));
+	}
+}
+
+void Memory::Install(const MemoryConfig& config) {
+	if (pool.installed)
+		throw Exception("SQLite memory is already configured");
+
+	// Configuration is only accepted while SQLite is not initialized
+	sqlite3_shutdown();
+	sqlite3_mem_methods defaults;
+	check(sqlite3_config(SQLITE_CONFIG_GETMALLOC, &defaults), "allocator");
+	try {
+		if (config.arena > 0) {
+			pool.arena = new char[config.arena];
+			pool.reserved = config.arena;
+			sqlite3_mem_methods methods;
+			methods.xMalloc = pool_malloc;
+			methods.xFree = pool_free;
+			methods.xRealloc = pool_realloc;
+			methods.xSize = pool_size;
+			methods.xRoundup = pool_roundup;
+			methods.xInit = pool_init;
+			methods.xShutdown = pool_shutdown;
+			methods.pAppData = nullptr;
+			check(sqlite3_config(SQLITE_CONFIG_MALLOC, &methods), "allocator");
+		}
+		if (config.pages > 0) {
+			// Each slot holds the page plus the page cache's own header
+			int page_header = 0;
+			check(sqlite3_config(SQLITE_CONFIG_PCACHE_HDRSZ, &page_header), "page cache");
+			const size_t slot = config.page_size + static_cast<size_t>(page_header);
+			pool.pages = new char[slot * config.pages];
+			check(sqlite3_config(SQLITE_CONFIG_PAGECACHE, pool.pages, static_cast<int>(slot), static_cast<int>(config.pages)), "page cache");
+		}
+		if (config.lookaside_slot_size > 0 && config.lookaside_slots > 0)
+			check(sqlite3_config(SQLITE_CONFIG_LOOKASIDE, config.lookaside_slot_size, config.lookaside_slots), "lookaside");
+		check(sqlite3_initialize(), "initialization");
+	}
+	catch (...) {
+		// Nothing was handed out yet, back to SQLite's own allocator
+		sqlite3_shutdown();
+		sqlite3_config(SQLITE_CONFIG_MALLOC, &defaults);
+		sqlite3_config(SQLITE_CONFIG_PAGECACHE, nullptr, 0, 0);
+		delete[] pool.arena;
+		delete[] pool.pages;
+		pool.arena = pool.pages = nullptr;
+		pool.reserved = 0;
+		throw;
+	}
+	pool.installed = true;
+}
+
+bool Memory::Installed() noexcept {
+	return pool.installed;
+}
+
+MemoryStats Memory::Stats() noexcept {
+	MemoryStats stats;
+	{
+		std::lock_guard<std::mutex> lock(pool.mutex);
+		stats.reserved = pool.reserved;
+		stats.used = pool.used;
+		stats.high_water = pool.high_water;
+		stats.allocations = pool.allocations;
+		stats.overflow = pool.overflow;
+	}
+	sqlite3_int64 current = 0, highest = 0;
+	if (sqlite3_status64(SQLITE_STATUS_PAGECACHE_USED, &current, &highest, 0) == SQLITE_OK)
+		stats.pages_used = static_cast<size_t>(current);
+	if (sqlite3_status64(SQLITE_STATUS_PAGECACHE_OVERFLOW, &current, &highest, 0) == SQLITE_OK)
+		stats.pages_overflow = static_cast<size_t>(current);
+	return stats;
+}
+
+void Memory::ResetHighWater() noexcept {
+	std::lock_guard<std::mutex> lock(pool.mutex);
+	pool.high_water = pool.used;
+}
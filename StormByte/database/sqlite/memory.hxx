@@ -0,0 +1,58 @@
+#pragma once
+
+#ifdef STORMBYTE_ENABLE_SQLITE
+	#include <StormByte/visibility.h>
+
+	#include <cstddef>
+	#include <cstdint>
+
+	namespace StormByte::Database::SQLite {
+		// Process wide allocator setup, see Memory::Install
+		struct STORMBYTE_PUBLIC MemoryConfig {
+			size_t arena				= 0;	// Bytes reserved for SQLite allocations, 0 keeps the system allocator
+			size_t page_size			= 4096;	// Database page size the page cache slots are sized for
+			size_t pages				= 0;	// Page cache slots reserved up front, 0 takes pages from the allocator
+			int lookaside_slot_size		= 0;	// Per connection lookaside slot size, 0 keeps SQLite's default
+			int lookaside_slots			= 0;	// Per connection lookaside slots
+		};
+
+		struct STORMBYTE_PUBLIC MemoryStats {
+			size_t reserved				= 0;	// Arena size
+			size_t used					= 0;	// Bytes currently allocated, rounded up to their size class
+			size_t high_water			= 0;	// Highest value of used since install or ResetHighWater
+			size_t allocations			= 0;	// Live allocations
+			size_t overflow				= 0;	// Allocations served by the system allocator because the arena was full or they were too large
+			size_t pages_used			= 0;	// Reserved page cache slots in use
+			size_t pages_overflow		= 0;	// Page cache bytes taken from the allocator because all slots were in use
+		};
+
+		// Memory held by a single connection, from sqlite3_db_status
+		struct STORMBYTE_PUBLIC ConnectionMemory {
+			size_t cache_used			= 0;	// Page cache
+			size_t schema_used			= 0;	// Parsed schema
+			size_t statement_used		= 0;	// Prepared statements
+			size_t lookaside_used		= 0;	// Lookaside slots in use
+			size_t lookaside_high_water	= 0;
+			size_t lookaside_misses		= 0;	// Allocations that fell back to the allocator since the lookaside was full
+		};
+
+		/**
+		 * Replaces SQLite's allocator with a size class pool carved from a single
+		 * arena reserved up front, and optionally reserves the page cache slots
+		 * too, so many connections in one process stop fragmenting the heap.
+		 * Freed chunks go back to their class and are reused, allocations beyond
+		 * the arena or above the largest class use the system allocator and are
+		 * counted as overflow.
+		 */
+		class STORMBYTE_PUBLIC Memory {
+			public:
+				Memory()								= delete;
+
+				// Must run before any connection is opened, and only once per process
+				static void 					Install(const MemoryConfig&);
+				static bool 					Installed() noexcept;
+				static MemoryStats 				Stats() noexcept;
+				static void 					ResetHighWater() noexcept;
+		};
+	}
+#endif
@@ -1,73 +1,375 @@
+#include <StormByte/database/sqlite/commit_tracker.hxx>
+#include <StormByte/database/sqlite/deadline.hxx>
+#include <StormByte/database/sqlite/exception.hxx>
 #include <StormByte/database/sqlite/prepared_stmt.hxx>
+#include <StormByte/database/sqlite/preparer.hxx>
 #include <StormByte/database/sqlite/result.hxx>
+#include <StormByte/system/process.hxx>
 
-#include <limits>
+#include <optional>
 #include <sqlite3.h>
+#include <utility>
 
 using namespace StormByte::Database::SQLite;
 
-PreparedSTMT::PreparedSTMT(const std::string& query):m_query(query), m_stmt(nullptr) {}
+PreparedSTMT::PreparedSTMT(const std::string& query):m_query(query), m_stmt(nullptr), m_done(false), m_change_mark(0), m_lazy_rows(false),
+m_timeout(0), m_running(false), m_timed_out(false), m_bindings_lost(false) {}
 
-PreparedSTMT::PreparedSTMT(std::string&& query) noexcept:m_query(std::move(query)), m_stmt(nullptr) {}
+PreparedSTMT::PreparedSTMT(std::string&& query) noexcept:m_query(std::move(query)), m_stmt(nullptr), m_done(false), m_change_mark(0), m_lazy_rows(false),
+m_timeout(0), m_running(false), m_timed_out(false), m_bindings_lost(false) {}
 
 PreparedSTMT::~PreparedSTMT() noexcept {
+	release_row();
 	if (m_stmt) {
+		if (m_statement_totals)
+			m_statement_totals->add(m_query, take_status(true));
 		sqlite3_finalize(m_stmt);
 		m_stmt = nullptr;
 	}
 }
 
 void PreparedSTMT::Bind(const int& column, const void*) noexcept {
-	sqlite3_bind_null(m_stmt, column + 1);
+	bind_null(column + 1);
 }
 
 void PreparedSTMT::Bind(const int& column, const std::optional<int64_t>& val) noexcept {
-	if (val) {
-		if (*val < std::numeric_limits<int64_t>::max())
-			sqlite3_bind_int(m_stmt, column + 1, *val);
-		else
-			sqlite3_bind_int64(m_stmt, column + 1, *val);
-	}
-	else
-		Bind(column, nullptr);
+	bind_value(column + 1, val);
 }
 
 void PreparedSTMT::Bind(const int& column, const std::optional<std::string>& val) noexcept {
-	if (val)
-		sqlite3_bind_text(m_stmt, column + 1, val->c_str(), -1, SQLITE_STATIC);
-	else
-		Bind(column, nullptr);
+	bind_value(column + 1, val);
+}
+
+int PreparedSTMT::ParameterIndex(const std::string_view& name) const {
+	auto it = m_parameters.find(name);
+	if (it == m_parameters.end())
+		throw QueryError("Parameter " + std::string(name) + " does not exist in " + m_query);
+	return it->second - 1;
 }
 
 void PreparedSTMT::Reset() noexcept {
+	release_row();
 	sqlite3_clear_bindings(m_stmt);
+	for (std::string& binding: m_bindings)
+		binding.clear();
+	m_bindings_lost = false;
+	collect_status();
+	const int rc = sqlite3_reset(m_stmt);
+	// Cut short, an autocommit write only commits now
+	if (m_running && m_tracker)
+		m_tracker->finished(*this, rc == SQLITE_OK ? SQLITE_DONE : rc);
+	m_done = false;
+	m_running = false;
+	m_column_names.reset(); // A schema change may reprepare the statement with other columns
+}
+
+void PreparedSTMT::Execute() {
+	int rc;
+	while ((rc = step()) == SQLITE_ROW);
+	collect_status();
+	if (rc != SQLITE_DONE) {
+		sqlite3_reset(m_stmt);
+		throw_error(rc);
+	}
 	sqlite3_reset(m_stmt);
 }
 
 std::shared_ptr<Row> PreparedSTMT::Step() {
 	std::shared_ptr<Row> result = nullptr;
-	if (sqlite3_step(m_stmt) == SQLITE_ROW) {
-		for (auto i = 0; i < sqlite3_column_count(m_stmt); i++) {
-			std::shared_ptr<Result> item;
-			switch(sqlite3_column_type(m_stmt, i)) {
-				case SQLITE_INTEGER:
-					item = std::make_shared<Result>(sqlite3_column_int(m_stmt, i));
-					break;
-
-				case SQLITE_TEXT:
-					item = std::make_shared<Result>(std::string(reinterpret_cast<const char*>(sqlite3_column_text(m_stmt, i))));
-					break;
-
-				case SQLITE_NULL:
-					item = std::make_shared<Result>(nullptr);
-					break;
-
-				default:
-					/* Not implemented all the cases */
-					item = nullptr;
+	const int rc = step();
+	if (rc == SQLITE_ROW) {
+		const int columns = sqlite3_column_count(m_stmt);
+		if (!m_column_names) {
+			auto names = std::make_shared<std::vector<std::string>>();
+			names->reserve(static_cast<size_t>(columns));
+			for (auto i = 0; i < columns; i++) {
+				const char* name = sqlite3_column_name(m_stmt, i);
+				names->push_back(name ? name : "");
 			}
-			result->add(std::string(sqlite3_column_name(m_stmt, i)), item);
+			m_column_names = std::move(names);
+		}
+
+		if (m_lazy_rows) {
+			result = std::shared_ptr<Row>(new Row(m_column_names, m_stmt));
+			m_lazy_row = result;
+		}
+		else {
+			result = std::shared_ptr<Row>(new Row(m_column_names));
+			for (auto i = 0; i < columns; i++)
+				result->add(Row::decode(m_stmt, i));
 		}
 	}
+	else if (rc != SQLITE_DONE)
+		throw_error(rc);
 	return result;
+}
+
+ColumnBatch PreparedSTMT::Fetch(const size_t& max_rows) {
+	ColumnBatch batch;
+	const int columns = sqlite3_column_count(m_stmt);
+	for (auto i = 0; i < columns; i++)
+		batch.add(std::string(sqlite3_column_name(m_stmt, i)));
+	if (max_rows > 0)
+		batch.reserve(max_rows);
+
+	// A statement stepped after SQLITE_DONE would silently restart
+	while (!m_done && (max_rows == 0 || batch.m_rows < max_rows)) {
+		const int rc = step();
+		if (rc == SQLITE_DONE)
+			m_done = true;
+		else if (rc == SQLITE_ROW) {
+			for (auto i = 0; i < columns; i++)
+				batch.m_columns[i].append(m_stmt, i);
+			batch.m_rows++;
+		}
+		else
+			throw_error(rc);
+	}
+	return batch;
+}
+
+ExportStatistics PreparedSTMT::Export(const std::function<bool(const char*, const size_t&)>& sink, const ExportFormat& format, const size_t& buffer_size) {
+	ExportStatistics statistics;
+	Exporter exporter(m_stmt, format, buffer_size);
+	const auto flush = [&]() {
+		if (exporter.rows() == 0)
+			return true;
+		if (!sink(exporter.buffer().data(), exporter.buffer().size()))
+			return false;
+		statistics.rows += exporter.rows();
+		statistics.bytes += exporter.buffer().size();
+		exporter.clear();
+		return true;
+	};
+
+	while (!m_done) {
+		const int rc = step();
+		if (rc == SQLITE_DONE)
+			m_done = true;
+		else if (rc == SQLITE_ROW) {
+			exporter.append();
+			if (exporter.full() && !flush()) {
+				statistics.complete = false;
+				return statistics;
+			}
+		}
+		else
+			throw_error(rc);
+	}
+	statistics.complete = flush();
+	return statistics;
+}
+
+ExportStatistics PreparedSTMT::Export(System::Process& process, const ExportFormat& format, const size_t& buffer_size) {
+	return Export([&process](const char* data, const size_t& size) { return process.write(data, size); }, format, buffer_size);
+}
+
+StatementStatus PreparedSTMT::Status(const bool& reset) noexcept {
+	const StatementStatus status = take_status(reset);
+	if (reset && m_statement_totals)
+		m_statement_totals->add(m_query, status);
+	return status;
+}
+
+void PreparedSTMT::SetLazyRows(const bool& lazy) noexcept {
+	m_lazy_rows = lazy;
+}
+
+void PreparedSTMT::SetTimeout(const std::chrono::milliseconds& timeout) noexcept {
+	m_timeout = timeout;
+}
+
+void PreparedSTMT::Cancel() noexcept {
+	sqlite3_interrupt(sqlite3_db_handle(m_stmt));
+	if (m_busy_handler)
+		m_busy_handler->cancel();
+}
+
+int PreparedSTMT::step() {
+	// Waits for transactions other threads have open, so this never runs inside them
+	std::unique_lock<std::recursive_mutex> transaction_lock;
+	if (m_transaction_mutex)
+		transaction_lock = std::unique_lock<std::recursive_mutex>(*m_transaction_mutex);
+	release_row();
+	if (!m_running) {
+		if (m_timeout.count() > 0)
+			m_deadline = std::chrono::steady_clock::now() + m_timeout;
+		if (m_tracker && m_tracker->active())
+			m_change_mark = m_tracker->mark();
+		if (m_busy_handler)
+			m_busy_handler->uncancel();
+	}
+	m_running = true;
+	m_timed_out = false;
+
+	std::optional<Deadline> deadline;
+	if (m_timeout.count() > 0 && m_busy_handler)
+		deadline.emplace(sqlite3_db_handle(m_stmt), m_deadline, *m_busy_handler);
+
+	const auto run = [this]() {
+		const Preparer::ErrorLock lock(sqlite3_db_handle(m_stmt));
+		const int rc = sqlite3_step(m_stmt);
+		if (rc != SQLITE_ROW && rc != SQLITE_DONE)
+			m_error = sqlite3_errmsg(sqlite3_db_handle(m_stmt));
+		return rc;
+	};
+
+	int rc;
+	unsigned int attempt = 0;
+	// Retrying is only safe outside explicit transactions, inside them the caller must roll back
+	while ((rc = run()) == SQLITE_BUSY && m_busy_handler
+		&& sqlite3_get_autocommit(sqlite3_db_handle(m_stmt)) && !(deadline && deadline->Expired()) && m_busy_handler->Retry(attempt++));
+
+	// Cancelled while waiting for a lock, which sqlite3_interrupt does not reach
+	if (rc == SQLITE_BUSY && m_busy_handler && m_busy_handler->cancelled()) {
+		rc = SQLITE_INTERRUPT;
+		m_error = "Query cancelled while waiting for a lock: " + m_query;
+	}
+	if (rc != SQLITE_ROW) {
+		m_running = false;
+		if (m_tracker)
+			m_tracker->finished(*this, rc);
+	}
+	if (deadline && (rc == SQLITE_INTERRUPT || rc == SQLITE_BUSY) && deadline->Expired())
+		m_timed_out = true;
+	return rc;
+}
+
+bool PreparedSTMT::next_row() {
+	// A statement stepped after SQLITE_DONE would silently restart
+	if (m_done)
+		return false;
+	const int rc = step();
+	if (rc == SQLITE_ROW)
+		return true;
+	m_done = true;
+	if (rc != SQLITE_DONE)
+		throw_error(rc);
+	return false;
+}
+
+void PreparedSTMT::index_parameters() {
+	m_parameters.clear();
+	const int count = sqlite3_bind_parameter_count(m_stmt);
+	for (int i = 1; i <= count; i++) {
+		// Anonymous ? parameters have no name
+		const char* name = sqlite3_bind_parameter_name(m_stmt, i);
+		if (name)
+			m_parameters.insert({ name, i });
+	}
+}
+
+int PreparedSTMT::parameter_count() const noexcept {
+	return sqlite3_bind_parameter_count(m_stmt);
+}
+
+int PreparedSTMT::column_count() const noexcept {
+	return sqlite3_column_count(m_stmt);
+}
+
+bool PreparedSTMT::column_null(const int& column) const noexcept {
+	return sqlite3_column_type(m_stmt, column) == SQLITE_NULL;
+}
+
+int64_t PreparedSTMT::column_integer(const int& column) const noexcept {
+	return sqlite3_column_int64(m_stmt, column);
+}
+
+double PreparedSTMT::column_double(const int& column) const noexcept {
+	return sqlite3_column_double(m_stmt, column);
+}
+
+std::string_view PreparedSTMT::column_text(const int& column) const noexcept {
+	// Text first, its size is only right once the conversion happened
+	const char* text = reinterpret_cast<const char*>(sqlite3_column_text(m_stmt, column));
+	return text ? std::string_view(text, static_cast<size_t>(sqlite3_column_bytes(m_stmt, column))) : std::string_view();
+}
+
+void PreparedSTMT::bind_null(const int& index) noexcept {
+	sqlite3_bind_null(m_stmt, index);
+	if (index > 0 && static_cast<size_t>(index) <= m_bindings.size())
+		m_bindings[static_cast<size_t>(index) - 1].clear();
+}
+
+void PreparedSTMT::bind_integer(const int& index, const int64_t& value) noexcept {
+	sqlite3_bind_int64(m_stmt, index, value);
+	record_binding(index, 'i', &value, sizeof(value));
+}
+
+void PreparedSTMT::bind_double(const int& index, const double& value) noexcept {
+	sqlite3_bind_double(m_stmt, index, value);
+	record_binding(index, 'f', &value, sizeof(value));
+}
+
+void PreparedSTMT::bind_text(const int& index, const std::string_view& value) noexcept {
+	// Copied, bound values often are temporaries
+	sqlite3_bind_text64(m_stmt, index, value.data(), value.size(), SQLITE_TRANSIENT, SQLITE_UTF8);
+	record_binding(index, 't', value.data(), value.size());
+}
+
+void PreparedSTMT::record_binding(const int& index, const char& type, const void* data, const size_t& size) noexcept {
+	// Kept apart from SQLite, whose expanded SQL rounds doubles to 15 digits
+	if (index <= 0)
+		return;
+	try {
+		if (m_bindings.size() < static_cast<size_t>(index))
+			m_bindings.resize(static_cast<size_t>(index));
+		std::string& binding = m_bindings[static_cast<size_t>(index) - 1];
+		binding.assign(1, type);
+		binding.append(static_cast<const char*>(data), size);
+	}
+	catch (...) {
+		m_bindings_lost = true;
+	}
+}
+
+std::optional<std::string> PreparedSTMT::binding_key() const {
+	if (m_bindings_lost)
+		return std::nullopt;
+	// Every part is prefixed with its size so that no two bindings give the same key
+	std::string key;
+	const auto append = [&key](const std::string& part) {
+		const uint64_t size = part.size();
+		key.append(reinterpret_cast<const char*>(&size), sizeof(size));
+		key += part;
+	};
+	append(m_query);
+	for (const std::string& binding: m_bindings)
+		append(binding);
+	return key;
+}
+
+void PreparedSTMT::release_row() noexcept {
+	// The lazy row handed out last reads the statement's current row, which is about to change
+	if (std::shared_ptr<Row> row = m_lazy_row.lock())
+		row->materialize();
+	m_lazy_row.reset();
+}
+
+void PreparedSTMT::collect_status() noexcept {
+	// SQLite's counters are 32 bit, so they are zeroed every time they are added up
+	m_status.fullscan_steps	+= static_cast<uint32_t>(sqlite3_stmt_status(m_stmt, SQLITE_STMTSTATUS_FULLSCAN_STEP, 1));
+	m_status.sorts			+= static_cast<uint32_t>(sqlite3_stmt_status(m_stmt, SQLITE_STMTSTATUS_SORT, 1));
+	m_status.autoindexes	+= static_cast<uint32_t>(sqlite3_stmt_status(m_stmt, SQLITE_STMTSTATUS_AUTOINDEX, 1));
+	m_status.vm_steps		+= static_cast<uint32_t>(sqlite3_stmt_status(m_stmt, SQLITE_STMTSTATUS_VM_STEP, 1));
+	m_status.reprepares		+= static_cast<uint32_t>(sqlite3_stmt_status(m_stmt, SQLITE_STMTSTATUS_REPREPARE, 1));
+	m_status.runs			+= static_cast<uint32_t>(sqlite3_stmt_status(m_stmt, SQLITE_STMTSTATUS_RUN, 1));
+}
+
+StatementStatus PreparedSTMT::take_status(const bool& clear) noexcept {
+	collect_status();
+	return clear ? std::exchange(m_status, {}) : m_status;
+}
+
+void PreparedSTMT::throw_error(const int& rc) {
+	// Read by step along with the failure, the connection's own may belong to another call by now
+	std::string message = m_error;
+	if (m_timed_out)
+		throw QueryInterrupted("Query exceeded its " + std::to_string(m_timeout.count()) + "ms deadline: " + m_query);
+	else if (rc == SQLITE_INTERRUPT)
+		throw QueryInterrupted(std::move(message));
+	else if (rc == SQLITE_BUSY || rc == SQLITE_LOCKED)
+		throw DatabaseBusy(std::move(message));
+	else
+		throw QueryError(std::move(message));
 }
\ No newline at end of file
@@ -1,17 +1,39 @@
 #pragma once
 
 #ifdef STORMBYTE_ENABLE_SQLITE
+	#include <StormByte/database/sqlite/busy_handler.hxx>
+	#include <StormByte/database/sqlite/column_batch.hxx>
+	#include <StormByte/database/sqlite/exporter.hxx>
 	#include <StormByte/database/sqlite/row.hxx>
+	#include <StormByte/database/sqlite/statement_status.hxx>
 
+	#include <chrono>
 	#include <cstdint>
+	#include <functional>
 	#include <memory>
+	#include <mutex>
 	#include <optional>
 	#include <string>
+	#include <string_view>
+	#include <type_traits>
+	#include <unordered_map>
+	#include <vector>
 
 	class sqlite3_stmt;
+	namespace StormByte::System {
+		class Process;
+	}
 	namespace StormByte::Database::SQLite {
+		class CommitTracker;
+		struct StatementTables;
+		template<typename T> class StructBinder;
+		template<typename P, typename C> class TypedSTMT;
 		class STORMBYTE_PUBLIC PreparedSTMT {
+			friend class CommitTracker;
+			friend class KVStore;
 			friend class SQLite3;
+			template<typename T> friend class StructBinder;
+			template<typename P, typename C> friend class TypedSTMT;
 			public:
 				PreparedSTMT(const PreparedSTMT&) 					= delete;
 				PreparedSTMT(PreparedSTMT&&) noexcept				= default;
@@ -22,16 +44,103 @@
 				void 					Bind(const int&, const void*) noexcept; // Sintactic sugar for bind NULL
 				void					Bind(const int&, const std::optional<int64_t>&) noexcept;
 				void 					Bind(const int&, const std::optional<std::string>&) noexcept;
+				// Named parameters keep their prefix (":id", "@id", "$id"), values may be numbers, text, nullptr or optionals of them
+				template<typename N, typename V> requires (!std::is_arithmetic_v<N> && std::is_convertible_v<const N&, std::string_view>)
+				void 					Bind(const N&, const V&);
+				int 					ParameterIndex(const std::string_view&) const; // Same base as positional Bind
 
 				void 					Reset() noexcept;
+				void 					Execute();
 				std::shared_ptr<Row> 	Step();
+				// Lazy rows decode cells on access instead of copying every column on Step
+				void					SetLazyRows(const bool& = true) noexcept;
+				// Time limit for each execution (from its first step until done or Reset), 0 disables it
+				void					SetTimeout(const std::chrono::milliseconds&) noexcept;
+				// Thread safe: interrupts every statement the connection is running right now
+				void					Cancel() noexcept;
+				ColumnBatch				Fetch(const size_t& = 0); // 0 fetches until completion
+				// Serializes the remaining rows into one reusable buffer handed to the sink every buffer size bytes;
+				// a blocking sink is the backpressure and returning false stops the export
+				ExportStatistics		Export(const std::function<bool(const char*, const size_t&)>&, const ExportFormat& = ExportFormat::TSV, const size_t& = 64 * 1024);
+				// Into the process' stdin, which stays open
+				ExportStatistics		Export(System::Process&, const ExportFormat& = ExportFormat::TSV, const size_t& = 64 * 1024);
+				// Counters since the statement was compiled or last reset, which still count for SQLite3::statement_status
+				StatementStatus			Status(const bool& = false) noexcept;
 
 			private:
 				PreparedSTMT(const std::string&);
 				PreparedSTMT(std::string&&) noexcept;
+				struct NameHash {
+					using is_transparent = void;
+					size_t operator()(const std::string_view& name) const noexcept { return std::hash<std::string_view>()(name); }
+				};
+
+				int step();
+				// Steps once, false when done (and from then on until Reset)
+				bool next_row();
+				void index_parameters();
+				int parameter_count() const noexcept;
+				int column_count() const noexcept;
+				// Current row, converted by SQLite whatever the stored type
+				bool column_null(const int&) const noexcept;
+				int64_t column_integer(const int&) const noexcept;
+				double column_double(const int&) const noexcept;
+				std::string_view column_text(const int&) const noexcept;
+				// SQLite parameter numbers, that is ParameterIndex() + 1
+				void bind_null(const int&) noexcept;
+				void bind_integer(const int&, const int64_t&) noexcept;
+				void bind_double(const int&, const double&) noexcept;
+				void bind_text(const int&, const std::string_view&) noexcept;
+				void bind_value(const int& index, std::nullptr_t) noexcept { bind_null(index); }
+				void bind_value(const int& index, const char* value) noexcept { value ? bind_text(index, value) : bind_null(index); }
+				void bind_value(const int& index, const std::string_view& value) noexcept { bind_text(index, value); }
+				void bind_value(const int& index, const std::string& value) noexcept { bind_text(index, value); }
+				template<typename V> requires std::is_integral_v<V> void bind_value(const int& index, const V& value) noexcept {
+					bind_integer(index, static_cast<int64_t>(value));
+				}
+				template<typename V> requires std::is_floating_point_v<V> void bind_value(const int& index, const V& value) noexcept {
+					bind_double(index, static_cast<double>(value));
+				}
+				template<typename V> void bind_value(const int& index, const std::optional<V>& value) noexcept {
+					if (value)
+						bind_value(index, *value);
+					else
+						bind_null(index);
+				}
+				void record_binding(const int&, const char&, const void*, const size_t&) noexcept;
+				// The SQL with the exact values bound, nullopt if one could not be recorded
+				std::optional<std::string> binding_key() const;
+				void release_row() noexcept;
+				// Moves SQLite's counters into the statement's own, optionally handing those back and clearing them
+				void collect_status() noexcept;
+				StatementStatus take_status(const bool&) noexcept;
+				void throw_error(const int&);
 
 				std::string m_query;
 				sqlite3_stmt* m_stmt;
+				bool m_done;
+				std::shared_ptr<BusyHandler> m_busy_handler;
+				std::shared_ptr<CommitTracker> m_tracker;
+				std::shared_ptr<const StatementTables> m_tables; // Recorded when compiled for the query cache, nullptr otherwise
+				std::shared_ptr<std::recursive_mutex> m_transaction_mutex; // The connection's, held by open transactions
+				std::shared_ptr<StatementTotals> m_statement_totals; // Where the counters go when finalized or reset by Status
+				StatementStatus m_status;
+				size_t m_change_mark; // Change feed position when the running execution started
+				std::shared_ptr<const std::vector<std::string>> m_column_names;
+				bool m_lazy_rows;
+				std::chrono::milliseconds m_timeout;
+				std::chrono::steady_clock::time_point m_deadline;
+				bool m_running, m_timed_out;
+				std::string m_error; // Message of the last failed step
+				std::weak_ptr<Row> m_lazy_row;
+				std::unordered_map<std::string, int, NameHash, std::equal_to<>> m_parameters; // Name to SQLite parameter number
+				std::vector<std::string> m_bindings; // Type and bytes of each bound parameter, empty for NULL
+				bool m_bindings_lost;
 		};
+
+		template<typename N, typename V> requires (!std::is_arithmetic_v<N> && std::is_convertible_v<const N&, std::string_view>)
+		void PreparedSTMT::Bind(const N& name, const V& value) {
+			bind_value(ParameterIndex(name) + 1, value);
+		}
 	}
 #endif
\ No newline at end of file
@@ -0,0 +1,68 @@
+#include <StormByte/database/sqlite/preparer.hxx>
+
+#include <algorithm>
+#include <sqlite3.h>
+
+using namespace StormByte::Database::SQLite;
+
+Preparer::ErrorLock::ErrorLock(sqlite3* database) noexcept:m_mutex(sqlite3_db_mutex(database)) {
+	sqlite3_mutex_enter(m_mutex);
+}
+
+Preparer::ErrorLock::~ErrorLock() noexcept {
+	sqlite3_mutex_leave(m_mutex);
+}
+
+bool Preparer::Supported(sqlite3* database) noexcept {
+	// Only serialized connections have a mutex
+	return sqlite3_threadsafe() != 0 && sqlite3_db_mutex(database) != nullptr;
+}
+
+Preparer::Preparer(sqlite3* database, std::deque<std::pair<std::string, std::string>>&& pending):
+m_database(database), m_pending(std::move(pending)), m_stop(false) {
+	m_preparer = std::thread(&Preparer::run, this);
+}
+
+Preparer::~Preparer() noexcept {
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_stop = true;
+	}
+	if (m_preparer.joinable())
+		m_preparer.join();
+	for (auto& compiled: m_compiled)
+		sqlite3_finalize(compiled.second);
+}
+
+sqlite3_stmt* Preparer::take(const std::string& name) noexcept {
+	std::unique_lock<std::mutex> lock(m_mutex);
+	// Compiling it twice would cost more than waiting for the one in progress
+	m_cv.wait(lock, [this, &name] { return m_current != name; });
+	auto it = m_compiled.find(name);
+	if (it != m_compiled.end()) {
+		sqlite3_stmt* stmt = it->second;
+		m_compiled.erase(it);
+		return stmt;
+	}
+	m_pending.erase(std::remove_if(m_pending.begin(), m_pending.end(), [&name](const auto& pending) { return pending.first == name; }), m_pending.end());
+	return nullptr;
+}
+
+void Preparer::run() noexcept {
+	std::unique_lock<std::mutex> lock(m_mutex);
+	while (!m_stop && !m_pending.empty()) {
+		std::pair<std::string, std::string> pending = std::move(m_pending.front());
+		m_pending.pop_front();
+		m_current = pending.first;
+		lock.unlock();
+
+		sqlite3_stmt* stmt = nullptr;
+		sqlite3_prepare_v2(m_database, pending.second.c_str(), static_cast<int>(pending.second.length()), &stmt, nullptr);
+
+		lock.lock();
+		m_current.clear();
+		if (stmt && !m_compiled.insert({ pending.first, stmt }).second)
+			sqlite3_finalize(stmt);
+		m_cv.notify_all();
+	}
+}
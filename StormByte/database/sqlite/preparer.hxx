@@ -0,0 +1,68 @@
+#pragma once
+
+#ifdef STORMBYTE_ENABLE_SQLITE
+	#include <StormByte/visibility.h>
+
+	#include <condition_variable>
+	#include <deque>
+	#include <map>
+	#include <mutex>
+	#include <string>
+	#include <thread>
+	#include <utility>
+
+	class sqlite3;
+	class sqlite3_mutex;
+	class sqlite3_stmt;
+	namespace StormByte::Database::SQLite {
+		/**
+		 * Compiles declared sentences on a background thread over the same
+		 * connection, which must be serialized, so they are ready by the time they
+		 * are first asked for. Sentences that fail here are left to be compiled on
+		 * demand, where the error is reported.
+		 */
+		class STORMBYTE_PRIVATE Preparer {
+			public:
+				/**
+				 * Connection mutex held from a call that may fail until its error is read,
+				 * as every background compile replaces the connection's error.
+				 */
+				class STORMBYTE_PRIVATE ErrorLock {
+					public:
+						ErrorLock(sqlite3*) noexcept;
+						ErrorLock(const ErrorLock&)				= delete;
+						ErrorLock(ErrorLock&&)					= delete;
+						ErrorLock& operator=(const ErrorLock&)	= delete;
+						ErrorLock& operator=(ErrorLock&&)		= delete;
+						~ErrorLock() noexcept;
+
+					private:
+						sqlite3_mutex* m_mutex; // nullptr unless the connection is serialized
+				};
+
+				static bool Supported(sqlite3*) noexcept;
+
+				Preparer(sqlite3*, std::deque<std::pair<std::string, std::string>>&&);
+				Preparer(const Preparer&)				= delete;
+				Preparer(Preparer&&)					= delete;
+				Preparer& operator=(const Preparer&)	= delete;
+				Preparer& operator=(Preparer&&)			= delete;
+				~Preparer() noexcept;
+
+				// The compiled statement (now owned by the caller) or nullptr, either way the name is not compiled here anymore
+				sqlite3_stmt* take(const std::string&) noexcept;
+
+			private:
+				void run() noexcept;
+
+				sqlite3* m_database;
+				std::deque<std::pair<std::string, std::string>> m_pending; // Name and SQL
+				std::map<std::string, sqlite3_stmt*> m_compiled;
+				std::string m_current;
+				bool m_stop;
+				std::mutex m_mutex;
+				std::condition_variable m_cv;
+				std::thread m_preparer;
+		};
+	}
+#endif
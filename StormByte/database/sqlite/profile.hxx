@@ -0,0 +1,15 @@
+#pragma once
+
+#ifdef STORMBYTE_ENABLE_SQLITE
+	#include <StormByte/visibility.h>
+
+	namespace StormByte::Database::SQLite {
+		// Pragma sets applied together when the database is opened, see SQLite3::init_database
+		enum class STORMBYTE_PUBLIC Profile: unsigned short {
+			Default = 0,	// SQLite defaults, nothing is changed
+			ReadHeavy,		// WAL, large cache and memory mapped reads
+			WriteHeavy,		// WAL with NORMAL sync and larger pages for bulk inserts
+			Ephemeral		// No durability, for caches and scratch data that can be rebuilt
+		};
+	}
+#endif
@@ -0,0 +1,166 @@
+#include <StormByte/database/sqlite/profiler.hxx>
+
+#include <algorithm>
+#include <bit>
+#include <cctype>
+#include <iomanip>
+#include <sstream>
+#include <sqlite3.h>
+
+using namespace StormByte::Database::SQLite;
+
+std::chrono::nanoseconds StatementProfile::Percentile(const double& percentile) const noexcept {
+	if (calls == 0)
+		return std::chrono::nanoseconds(0);
+
+	const uint64_t target = std::max<uint64_t>(1, static_cast<uint64_t>(percentile / 100.0 * static_cast<double>(calls) + 0.5));
+	uint64_t seen = 0;
+	for (size_t i = 0; i < BUCKETS; i++) {
+		seen += histogram[i];
+		// Upper bound of the bucket, clamped to what was really observed
+		if (seen >= target)
+			return std::min(max, std::chrono::nanoseconds(i + 1 < 63 ? (int64_t(1) << (i + 1)) - 1 : max.count()));
+	}
+	return max;
+}
+
+void Profiler::SetSlowQueryLog(Log::Logger* logger, const std::chrono::nanoseconds& threshold, const Log::Level& level) {
+	std::lock_guard<std::mutex> lock(m_mutex);
+	m_logger = logger;
+	m_threshold = threshold;
+	m_level = level;
+}
+
+std::vector<StatementProfile> Profiler::Top(const size_t& count) const {
+	std::vector<StatementProfile> result;
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		result.reserve(m_profiles.size());
+		for (const auto& profile: m_profiles)
+			result.push_back(profile.second);
+	}
+	const size_t n = std::min(count, result.size());
+	std::partial_sort(result.begin(), result.begin() + n, result.end(),
+		[](const StatementProfile& a, const StatementProfile& b) { return a.total > b.total; });
+	result.resize(n);
+	return result;
+}
+
+std::string Profiler::Report(const size_t& count) const {
+	auto to_us = [](const std::chrono::nanoseconds& ns) { return std::to_string(ns.count() / 1000); };
+	std::ostringstream out;
+	out << std::left << std::setw(12) << "total(us)" << std::setw(10) << "calls" << std::setw(10) << "avg(us)"
+		<< std::setw(10) << "p99(us)" << std::setw(10) << "max(us)" << "sql\n";
+	for (const auto& profile: Top(count)) {
+		out << std::setw(12) << to_us(profile.total) << std::setw(10) << profile.calls
+			<< std::setw(10) << to_us(profile.total / profile.calls) << std::setw(10) << to_us(profile.Percentile(99))
+			<< std::setw(10) << to_us(profile.max) << profile.sql << "\n";
+	}
+	return out.str();
+}
+
+void Profiler::Reset() noexcept {
+	std::lock_guard<std::mutex> lock(m_mutex);
+	m_profiles.clear();
+}
+
+void Profiler::Record(const std::string& sql, const std::chrono::nanoseconds& elapsed) {
+	std::lock_guard<std::mutex> lock(m_mutex);
+	auto normalized = m_normalized.find(sql);
+	if (normalized == m_normalized.end()) {
+		// Ad hoc queries with inlined literals would otherwise grow this cache forever
+		if (m_normalized.size() >= MAX_CACHED_SQL)
+			m_normalized.clear();
+		normalized = m_normalized.insert({ sql, Normalize(sql) }).first;
+	}
+
+	StatementProfile& profile = m_profiles[normalized->second];
+	if (profile.calls == 0) {
+		profile.sql = normalized->second;
+		profile.min = elapsed;
+	}
+	profile.calls++;
+	profile.total += elapsed;
+	profile.min = std::min(profile.min, elapsed);
+	profile.max = std::max(profile.max, elapsed);
+	const uint64_t ns = static_cast<uint64_t>(std::max<int64_t>(elapsed.count(), 1));
+	profile.histogram[std::min<size_t>(std::bit_width(ns) - 1, StatementProfile::BUCKETS - 1)]++;
+
+	if (m_logger && elapsed >= m_threshold) {
+		*m_logger << m_level << "Slow query (" + std::to_string(elapsed.count() / 1000) + "us): " + normalized->second
+			<< Log::Logger::endl;
+	}
+}
+
+int Profiler::Callback(unsigned int type, void* data, void* stmt, void* extra) {
+	Profiler* profiler = static_cast<Profiler*>(data);
+	if (type == SQLITE_TRACE_STMT) {
+		// Trigger subprograms report "-- comment" texts and must not restart the clock
+		const char* text = static_cast<const char*>(extra);
+		if (!text || text[0] != '-' || text[1] != '-') {
+			std::lock_guard<std::mutex> lock(profiler->m_mutex);
+			profiler->m_started[stmt] = std::chrono::steady_clock::now();
+		}
+	}
+	else if (type == SQLITE_TRACE_PROFILE) {
+		std::chrono::nanoseconds elapsed { *static_cast<sqlite3_int64*>(extra) };
+		{
+			std::lock_guard<std::mutex> lock(profiler->m_mutex);
+			auto it = profiler->m_started.find(stmt);
+			if (it != profiler->m_started.end()) {
+				elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - it->second);
+				profiler->m_started.erase(it);
+			}
+		}
+		const char* sql = sqlite3_sql(static_cast<sqlite3_stmt*>(stmt));
+		if (sql)
+			profiler->Record(sql, elapsed);
+	}
+	return 0;
+}
+
+std::string Profiler::Normalize(const std::string& sql) {
+	std::string out;
+	out.reserve(sql.size());
+	size_t i = 0;
+	while (i < sql.size()) {
+		const char c = sql[i];
+		const bool after_word = !out.empty() && (std::isalnum(static_cast<unsigned char>(out.back())) || out.back() == '_');
+		if (std::isspace(static_cast<unsigned char>(c))) {
+			while (i < sql.size() && std::isspace(static_cast<unsigned char>(sql[i])))
+				i++;
+			if (!out.empty())
+				out += ' ';
+		}
+		else if (c == '\'' || ((c == 'x' || c == 'X') && !after_word && i + 1 < sql.size() && sql[i + 1] == '\'')) {
+			// String and blob literals, '' is an escaped quote
+			i += (c == '\'') ? 1 : 2;
+			while (i < sql.size()) {
+				if (sql[i] == '\'' && (i + 1 >= sql.size() || sql[i + 1] != '\'')) {
+					i++;
+					break;
+				}
+				i += (sql[i] == '\'') ? 2 : 1;
+			}
+			out += '?';
+		}
+		else if (c == '"' || c == '`' || c == '[') {
+			// Quoted identifiers are kept as they are
+			const char close = (c == '[') ? ']' : c;
+			const size_t end = sql.find(close, i + 1);
+			const size_t len = (end == std::string::npos) ? sql.size() - i : end - i + 1;
+			out.append(sql, i, len);
+			i += len;
+		}
+		else if (std::isdigit(static_cast<unsigned char>(c)) && !after_word) {
+			while (i < sql.size() && (std::isalnum(static_cast<unsigned char>(sql[i])) || sql[i] == '.'))
+				i++;
+			out += '?';
+		}
+		else
+			out += sql[i++];
+	}
+	while (!out.empty() && (out.back() == ' ' || out.back() == ';'))
+		out.pop_back();
+	return out;
+}
@@ -0,0 +1,64 @@
+#pragma once
+
+#ifdef STORMBYTE_ENABLE_SQLITE
+	#include <StormByte/log/logger.hxx>
+
+	#include <array>
+	#include <chrono>
+	#include <cstdint>
+	#include <mutex>
+	#include <string>
+	#include <unordered_map>
+	#include <vector>
+
+	namespace StormByte::Database::SQLite {
+		struct STORMBYTE_PUBLIC StatementProfile {
+			static constexpr size_t BUCKETS = 64; // Bucket i holds latencies in [2^i, 2^(i+1)) ns
+
+			std::string sql;
+			uint64_t calls											= 0;
+			std::chrono::nanoseconds total							{ 0 };
+			std::chrono::nanoseconds min							{ 0 };
+			std::chrono::nanoseconds max							{ 0 };
+			std::array<uint64_t, BUCKETS> histogram					{};
+
+			std::chrono::nanoseconds Percentile(const double&) const noexcept;
+		};
+
+		/**
+		 * Latency histograms per normalized SQL (literals replaced by ?), fed by
+		 * sqlite3_trace_v2 events. SQLite reports profile times with the VFS clock
+		 * (millisecond resolution) so statements are timed from SQLITE_TRACE_STMT.
+		 */
+		class STORMBYTE_PUBLIC Profiler {
+			public:
+				Profiler()									= default;
+				Profiler(const Profiler&)					= delete;
+				Profiler(Profiler&&)						= delete;
+				Profiler& operator=(const Profiler&)		= delete;
+				Profiler& operator=(Profiler&&)				= delete;
+				~Profiler() noexcept						= default;
+
+				// Logger must outlive the profiler or be unset, nullptr disables slow query logging
+				void 							SetSlowQueryLog(Log::Logger*, const std::chrono::nanoseconds&, const Log::Level& = Log::Level::Warning);
+				std::vector<StatementProfile>	Top(const size_t&) const;
+				std::string 					Report(const size_t&) const;
+				void 							Reset() noexcept;
+
+				void 							Record(const std::string&, const std::chrono::nanoseconds&);
+				static int 						Callback(unsigned int, void*, void*, void*);
+				static std::string 				Normalize(const std::string&);
+
+			private:
+				static constexpr size_t MAX_CACHED_SQL = 4096;
+
+				mutable std::mutex m_mutex;
+				std::unordered_map<std::string, StatementProfile> m_profiles;
+				std::unordered_map<std::string, std::string> m_normalized; // Raw SQL to normalized SQL
+				std::unordered_map<void*, std::chrono::steady_clock::time_point> m_started;
+				Log::Logger* m_logger 						= nullptr;
+				std::chrono::nanoseconds m_threshold		{ 0 };
+				Log::Level m_level							= Log::Level::Warning;
+		};
+	}
+#endif
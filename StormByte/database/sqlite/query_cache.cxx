@@ -0,0 +1,120 @@
+#include <StormByte/database/sqlite/query_cache.hxx>
+
+using namespace StormByte::Database::SQLite;
+
+QueryCache::QueryCache(const size_t& max_entries):m_max_entries(max_entries > 0 ? max_entries : 1), m_epoch(0) {}
+
+std::shared_ptr<const ColumnBatch> QueryCache::Get(const std::string& key) {
+	std::lock_guard<std::mutex> lock(m_mutex);
+	auto it = m_entries.find(key);
+	if (it == m_entries.end()) {
+		m_statistics.misses++;
+		return nullptr;
+	}
+
+	m_statistics.hits++;
+	m_lru.splice(m_lru.begin(), m_lru, it->second.lru);
+	return it->second.result;
+}
+
+void QueryCache::Put(const std::string& key, std::shared_ptr<const ColumnBatch> result, const std::vector<std::string>& tables, const uint64_t& epoch) {
+	std::lock_guard<std::mutex> lock(m_mutex);
+	// Something was invalidated while the query ran so the result might already be stale
+	if (epoch != m_epoch)
+		return;
+
+	auto it = m_entries.find(key);
+	if (it != m_entries.end())
+		erase(it);
+
+	while (m_entries.size() >= m_max_entries) {
+		erase(m_entries.find(m_lru.back()));
+		m_statistics.evictions++;
+	}
+
+	m_lru.push_front(key);
+	m_entries.insert({ key, Entry { std::move(result), tables, m_lru.begin() } });
+	for (const auto& table: tables)
+		m_table_entries[table].insert(key);
+	m_statistics.entries = m_entries.size();
+}
+
+void QueryCache::Invalidate(const std::string& table) {
+	std::lock_guard<std::mutex> lock(m_mutex);
+	m_epoch++;
+	auto keys = m_table_entries.find(table);
+	if (keys == m_table_entries.end())
+		return;
+
+	const std::unordered_set<std::string> affected = std::move(keys->second);
+	m_table_entries.erase(keys);
+	for (const auto& key: affected) {
+		auto it = m_entries.find(key);
+		if (it != m_entries.end()) {
+			erase(it);
+			m_statistics.invalidations++;
+		}
+	}
+	m_statistics.entries = m_entries.size();
+}
+
+void QueryCache::Clear() noexcept {
+	std::lock_guard<std::mutex> lock(m_mutex);
+	m_epoch++;
+	m_statistics.invalidations += m_entries.size();
+	m_entries.clear();
+	m_lru.clear();
+	m_table_entries.clear();
+	m_statistics.entries = 0;
+}
+
+uint64_t QueryCache::Epoch() const noexcept {
+	std::lock_guard<std::mutex> lock(m_mutex);
+	return m_epoch;
+}
+
+QueryCacheStatistics QueryCache::Statistics() const noexcept {
+	std::lock_guard<std::mutex> lock(m_mutex);
+	return m_statistics;
+}
+
+void QueryCache::changed(const std::string& table) {
+	Invalidate(table);
+	std::lock_guard<std::mutex> lock(m_mutex);
+	m_dirty.insert(table);
+}
+
+void QueryCache::committed() noexcept {
+	std::lock_guard<std::mutex> lock(m_mutex);
+	m_dirty.clear();
+}
+
+void QueryCache::rolled_back() {
+	invalidate_dirty();
+	std::lock_guard<std::mutex> lock(m_mutex);
+	m_dirty.clear();
+}
+
+void QueryCache::invalidate_dirty() {
+	// Results cached after a change inside the transaction saw data which no longer exists
+	std::unordered_set<std::string> dirty;
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		dirty = m_dirty;
+	}
+	for (const auto& table: dirty)
+		Invalidate(table);
+}
+
+void QueryCache::erase(std::unordered_map<std::string, Entry>::iterator it) {
+	for (const auto& table: it->second.tables) {
+		auto keys = m_table_entries.find(table);
+		if (keys != m_table_entries.end()) {
+			keys->second.erase(it->first);
+			if (keys->second.empty())
+				m_table_entries.erase(keys);
+		}
+	}
+	m_lru.erase(it->second.lru);
+	m_entries.erase(it);
+}
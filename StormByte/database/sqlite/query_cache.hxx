@@ -0,0 +1,69 @@
+#pragma once
+
+#ifdef STORMBYTE_ENABLE_SQLITE
+	#include <StormByte/database/sqlite/column_batch.hxx>
+
+	#include <cstdint>
+	#include <list>
+	#include <memory>
+	#include <mutex>
+	#include <string>
+	#include <unordered_map>
+	#include <unordered_set>
+	#include <vector>
+
+	namespace StormByte::Database::SQLite {
+		struct STORMBYTE_PUBLIC QueryCacheStatistics {
+			uint64_t hits				= 0;
+			uint64_t misses				= 0;
+			uint64_t invalidations		= 0;	// Entries dropped because a table they read changed
+			uint64_t evictions			= 0;	// Entries dropped to honor the size limit
+			size_t entries				= 0;
+		};
+
+		/**
+		 * LRU cache of fully fetched results keyed by statement text and the exact
+		 * values bound to it. Entries are dropped when any table they read changes.
+		 */
+		class STORMBYTE_PUBLIC QueryCache {
+			friend class CommitTracker;
+			friend class SQLite3;
+			public:
+				QueryCache(const size_t&);
+				QueryCache(const QueryCache&)				= delete;
+				QueryCache(QueryCache&&)					= delete;
+				QueryCache& operator=(const QueryCache&)	= delete;
+				QueryCache& operator=(QueryCache&&)			= delete;
+				~QueryCache() noexcept						= default;
+
+				std::shared_ptr<const ColumnBatch>	Get(const std::string&);
+				void 								Put(const std::string&, std::shared_ptr<const ColumnBatch>, const std::vector<std::string>&, const uint64_t&);
+				void 								Invalidate(const std::string&);
+				void 								Clear() noexcept;
+				uint64_t 							Epoch() const noexcept;
+				QueryCacheStatistics				Statistics() const noexcept;
+
+			private:
+				struct Entry {
+					std::shared_ptr<const ColumnBatch> result;
+					std::vector<std::string> tables;
+					std::list<std::string>::iterator lru;
+				};
+
+				void changed(const std::string&);
+				void committed() noexcept;
+				void rolled_back();
+				void invalidate_dirty();
+				void erase(std::unordered_map<std::string, Entry>::iterator);
+
+				size_t m_max_entries;
+				mutable std::mutex m_mutex;
+				std::unordered_map<std::string, Entry> m_entries;
+				std::list<std::string> m_lru; // Most recently used first
+				std::unordered_map<std::string, std::unordered_set<std::string>> m_table_entries;
+				std::unordered_set<std::string> m_dirty; // Tables changed by the open transaction
+				uint64_t m_epoch;
+				QueryCacheStatistics m_statistics;
+		};
+	}
+#endif
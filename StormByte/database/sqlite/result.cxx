@@ -1,53 +1,139 @@
 #include <StormByte/database/sqlite/exception.hxx>
 #include <StormByte/database/sqlite/result.hxx>
 
+#include <cstring>
 #include <limits>
 
 using namespace StormByte::Database::SQLite;
 
-Result::Result(const int64_t& value):m_type(Type::Integer), m_value(value) {}
+static_assert(sizeof(Result) <= 24, "Result must stay small enough to be stored by value in rows");
 
-Result::Result(const std::string& value):m_type(Type::String), m_value(value) {}
+Result::Result(const int64_t& value) noexcept:m_integer(value), m_size(0), m_type(Type::Integer) {}
 
-Result::Result(std::string&& value):m_type(Type::String), m_value(std::move(value)) {}
+Result::Result(const double& value) noexcept:m_double(value), m_size(0), m_type(Type::Double) {}
 
-Result::Result(std::nullptr_t):m_type(Type::Null), m_value() {}
+Result::Result(const std::string_view& value):m_integer(0), m_size(0), m_type(Type::String) {
+	assign(value);
+}
+
+Result::Result(const std::string& value):Result(std::string_view(value)) {}
+
+Result::Result(const char* value):Result(std::string_view(value)) {}
+
+Result::Result(std::nullptr_t) noexcept:m_integer(0), m_size(0), m_type(Type::Null) {}
+
+Result::Result(const Result& other):m_integer(0), m_size(0), m_type(Type::Null) {
+	copy(other);
+}
+
+Result::Result(Result&& other) noexcept:m_size(other.m_size), m_type(other.m_type) {
+	// Raw union copy is valid for every alternative, the heap pointer is then owned by this
+	std::memcpy(m_small, other.m_small, SMALL_SIZE);
+	other.m_type = Type::Null;
+	other.m_size = 0;
+}
+
+Result& Result::operator=(const Result& other) {
+	if (this != &other) {
+		release();
+		copy(other);
+	}
+	return *this;
+}
+
+Result& Result::operator=(Result&& other) noexcept {
+	if (this != &other) {
+		release();
+		std::memcpy(m_small, other.m_small, SMALL_SIZE);
+		m_size = other.m_size;
+		m_type = other.m_type;
+		other.m_type = Type::Null;
+		other.m_size = 0;
+	}
+	return *this;
+}
+
+Result::~Result() noexcept {
+	release();
+}
 
 bool Result::IsNull() const noexcept { return m_type == Type::Null; }
 
 const Type& Result::GetType() const noexcept { return m_type; }
 
-template<> const int& Result::Value<int>() const {
+template<> int Result::Value<int>() const {
 	if (m_type != Type::Integer)
 		throw WrongResultType(m_type, Type::Integer);
 
-	if (std::get<int64_t>(m_value) > std::numeric_limits<int>::max())
-		throw Overflow(std::get<int64_t>(m_value));
-
-	m_int_conversion = std::get<int64_t>(m_value);
+	if (m_integer > std::numeric_limits<int>::max() || m_integer < std::numeric_limits<int>::min())
+		throw Overflow(m_integer);
 
-	return m_int_conversion;
+	return static_cast<int>(m_integer);
 }
 
-template<> const int64_t& Result::Value<int64_t>() const {
+template<> int64_t Result::Value<int64_t>() const {
 	if (m_type != Type::Integer)
 		throw WrongResultType(m_type, Type::Integer);
 
-	return std::get<int64_t>(m_value);
+	return m_integer;
 }
 
-template<> const bool& Result::Value<bool>() const {
-	if (m_type != Type::Integer || std::get<int64_t>(m_value) < 0 || std::get<int64_t>(m_value) > 1)
-		throw WrongResultType(m_type, Type::Bool);
+template<> double Result::Value<double>() const {
+	if (m_type != Type::Double)
+		throw WrongResultType(m_type, Type::Double);
+
+	return m_double;
+}
 
-	m_bool_conversion = std::get<int64_t>(m_value) == 1;
+template<> bool Result::Value<bool>() const {
+	if (m_type != Type::Integer || m_integer < 0 || m_integer > 1)
+		throw WrongResultType(m_type, Type::Bool);
 
-	return m_bool_conversion;
+	return m_integer == 1;
 }
 
-template<> const std::string& Result::Value<std::string>() const {
+template<> std::string_view Result::Value<std::string_view>() const {
 	if (m_type != Type::String)
 		throw WrongResultType(m_type, Type::String);
 
-	return std::get<std::string>(m_value);
+	return std::string_view(data(), m_size);
+}
+
+template<> std::string Result::Value<std::string>() const {
+	return std::string(Value<std::string_view>());
+}
+
+const char* Result::data() const noexcept {
+	return m_size <= SMALL_SIZE ? m_small : m_heap;
+}
+
+void Result::assign(const std::string_view& value) {
+	if (value.size() > std::numeric_limits<uint32_t>::max())
+		throw Overflow(static_cast<int64_t>(value.size()));
+
+	if (value.size() > SMALL_SIZE) {
+		m_heap = new char[value.size()];
+		std::memcpy(m_heap, value.data(), value.size());
+	}
+	else if (!value.empty())
+		std::memcpy(m_small, value.data(), value.size());
+	m_size = static_cast<uint32_t>(value.size());
+	m_type = Type::String;
+}
+
+void Result::copy(const Result& other) {
+	if (other.m_type == Type::String)
+		assign(std::string_view(other.data(), other.m_size));
+	else {
+		std::memcpy(m_small, other.m_small, SMALL_SIZE);
+		m_size = 0;
+		m_type = other.m_type;
+	}
+}
+
+void Result::release() noexcept {
+	if (m_type == Type::String && m_size > SMALL_SIZE)
+		delete[] m_heap;
+	m_type = Type::Null;
+	m_size = 0;
 }
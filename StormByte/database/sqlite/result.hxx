@@ -5,37 +5,56 @@
 
 	#include <cstdint>
 	#include <string>
-	#include <variant>
+	#include <string_view>
 
 	namespace StormByte::Database::SQLite {
+		/**
+		 * Value of a single cell, 24 bytes: numbers and strings up to SMALL_SIZE
+		 * bytes are stored inline and only longer strings use the heap.
+		 */
 		class STORMBYTE_PUBLIC Result {
 			public:
-				Result(const int64_t&);
+				static constexpr size_t SMALL_SIZE = 16;
+
+				Result(const int64_t&) noexcept;
+				Result(const double&) noexcept;
+				Result(const std::string_view&);
 				Result(const std::string&);
-				Result(std::string&&);
-				Result(std::nullptr_t);
-				Result(const Result&)							= default;
-				Result(Result&&) noexcept						= default;
-				Result& operator=(const Result&)				= default;
-				Result& operator=(Result&&) noexcept			= default;
-				~Result() noexcept								= default;
-
-				virtual bool 							IsNull() const noexcept;
-				template<typename T> const T&			Value() const;
+				Result(const char*);
+				Result(std::nullptr_t) noexcept;
+				Result(const Result&);
+				Result(Result&&) noexcept;
+				Result& operator=(const Result&);
+				Result& operator=(Result&&) noexcept;
+				~Result() noexcept;
+
+				bool 									IsNull() const noexcept;
+				template<typename T> T					Value() const;
 				#ifdef MSVC
-				template<> const int&					Value<int>() const;
-				template<> const int64_t&				Value<int64_t>() const;
-				template<> const bool&					Value<bool>() const;
-				template<> const std::string&			Value<std::string>() const;
+				template<> int							Value<int>() const;
+				template<> int64_t						Value<int64_t>() const;
+				template<> double						Value<double>() const;
+				template<> bool							Value<bool>() const;
+				template<> std::string					Value<std::string>() const;
+				template<> std::string_view				Value<std::string_view>() const; // Valid while the Result lives
 				#endif
 
 				const Type& 							GetType() const noexcept;
 
-			protected:
+			private:
+				union {
+					int64_t m_integer;
+					double m_double;
+					char* m_heap;
+					char m_small[SMALL_SIZE];
+				};
+				uint32_t m_size;
 				Type m_type;
-				std::variant<int64_t, std::string> m_value;
-				mutable bool m_bool_conversion;
-				mutable int m_int_conversion;
+
+				const char* data() const noexcept;
+				void assign(const std::string_view&);
+				void copy(const Result&);
+				void release() noexcept;
 		};
 	}
-#endif
\ No newline at end of file
+#endif
@@ -1,75 +1,140 @@
 #include <StormByte/database/sqlite/exception.hxx>
-#include <StormByte/database/sqlite/result.hxx>
 #include <StormByte/database/sqlite/row.hxx>
 
+#include <algorithm>
+#include <sqlite3.h>
+
 using namespace StormByte::Database::SQLite;
 
-void Row::add(std::string&& name, std::shared_ptr<Result> res) {
-	size_t curr_pos = m_column_pos_assoc.size();
-	m_column_name_assoc.insert({ std::move(name), res });
-	m_column_pos_assoc.insert({ std::move(curr_pos), res});
+Row::Row(std::shared_ptr<const std::vector<std::string>> names, sqlite3_stmt* stmt):m_names(std::move(names)), m_stmt(stmt) {
+	if (m_stmt) {
+		m_values.resize(m_names->size(), Result(nullptr));
+		m_decoded.resize(m_names->size(), false);
+	}
+	else
+		m_values.reserve(m_names->size());
 }
 
-size_t Row::Columns() const noexcept {
-	return m_column_pos_assoc.size();
+Row::Row(const Row& row):m_names(row.m_names), m_stmt(nullptr) {
+	row.materialize();
+	m_values = row.m_values;
+}
+
+Row::Row(Row&& row):m_names(std::move(row.m_names)), m_stmt(nullptr) {
+	// The statement only tracks the original object, so the moved to one can not stay lazy
+	row.materialize();
+	m_values = std::move(row.m_values);
 }
 
-std::shared_ptr<Result> Row::operator[](const size_t& pos) {
-	return get(pos);
+Row& Row::operator=(const Row& row) {
+	if (this != &row) {
+		row.materialize();
+		m_names = row.m_names;
+		m_values = row.m_values;
+		m_stmt = nullptr;
+		m_decoded.clear();
+	}
+	return *this;
 }
 
-const std::shared_ptr<Result> Row::operator[](const size_t& pos) const {
-	return get(pos);
+Row& Row::operator=(Row&& row) {
+	if (this != &row) {
+		row.materialize();
+		m_names = std::move(row.m_names);
+		m_values = std::move(row.m_values);
+		m_stmt = nullptr;
+		m_decoded.clear();
+	}
+	return *this;
 }
 
-std::shared_ptr<Result> Row::operator[](const std::string& name) {
-	return get(name);
+void Row::add(Result&& value) {
+	m_values.push_back(std::move(value));
 }
 
-const std::shared_ptr<Result> Row::operator[](const std::string& name) const {
-	return get(name);
+size_t Row::Columns() const noexcept {
+	return m_values.size();
 }
 
-std::shared_ptr<Result> Row::At(const size_t& pos) {
-	return get(pos);
+Result& Row::operator[](const size_t& pos) {
+	return At(pos);
 }
 
-const std::shared_ptr<Result> Row::At(const size_t& pos) const {
-	return get(pos);
+const Result& Row::operator[](const size_t& pos) const {
+	return At(pos);
 }
 
-std::shared_ptr<Result> Row::At(const std::string& name) {
-	return get(name);
+Result& Row::operator[](const std::string& name) {
+	return At(name);
 }
 
-const std::shared_ptr<Result> Row::At(const std::string& name) const {
-	return get(name);
+const Result& Row::operator[](const std::string& name) const {
+	return At(name);
 }
 
-std::shared_ptr<Result> Row::get(const size_t& pos) {
-	if (pos >= m_column_pos_assoc.size())
-		throw OutOfBounds(m_column_pos_assoc.size(), pos);
+Result& Row::At(const size_t& pos) {
+	if (pos >= m_values.size())
+		throw OutOfBounds(m_values.size(), pos);
 
-	return m_column_pos_assoc.at(pos);
+	return load(pos);
 }
 
-const std::shared_ptr<Result> Row::get(const size_t& pos) const {
-	if (pos >= m_column_pos_assoc.size())
-		throw OutOfBounds(m_column_pos_assoc.size(), pos);
+const Result& Row::At(const size_t& pos) const {
+	if (pos >= m_values.size())
+		throw OutOfBounds(m_values.size(), pos);
 
-	return m_column_pos_assoc.at(pos);
+	return load(pos);
 }
 
-std::shared_ptr<Result> Row::get(const std::string& name) {
-	if (m_column_name_assoc.find(name) == m_column_name_assoc.end())
-		throw OutOfBounds(name);
+Result& Row::At(const std::string& name) {
+	return load(index(name));
+}
 
-	return m_column_name_assoc.at(name);
+const Result& Row::At(const std::string& name) const {
+	return load(index(name));
 }
 
-const std::shared_ptr<Result> Row::get(const std::string& name) const {
-	if (m_column_name_assoc.find(name) == m_column_name_assoc.end())
+size_t Row::index(const std::string& name) const {
+	// Rows are narrow enough for a linear search to beat a per row map
+	auto it = std::find(m_names->begin(), m_names->end(), name);
+	if (it == m_names->end() || static_cast<size_t>(it - m_names->begin()) >= m_values.size())
 		throw OutOfBounds(name);
 
-	return m_column_name_assoc.at(name);
+	return static_cast<size_t>(it - m_names->begin());
+}
+
+Result& Row::load(const size_t& pos) const {
+	if (m_stmt && !m_decoded[pos]) {
+		m_values[pos] = decode(m_stmt, static_cast<int>(pos));
+		m_decoded[pos] = true;
+	}
+	return m_values[pos];
+}
+
+void Row::materialize() const {
+	if (m_stmt) {
+		for (size_t i = 0; i < m_values.size(); i++)
+			load(i);
+		m_stmt = nullptr;
+		m_decoded.clear();
+	}
+}
+
+Result Row::decode(sqlite3_stmt* stmt, const int& column) {
+	switch(sqlite3_column_type(stmt, column)) {
+		case SQLITE_INTEGER:
+			return Result(static_cast<int64_t>(sqlite3_column_int64(stmt, column)));
+
+		case SQLITE_FLOAT:
+			return Result(sqlite3_column_double(stmt, column));
+
+		case SQLITE_NULL:
+			return Result(nullptr);
+
+		default: {
+			// Text and blobs, sizes are read after the pointer as the docs require
+			const char* data = static_cast<const char*>(sqlite3_column_blob(stmt, column));
+			return Result(std::string_view(data ? data : "", static_cast<size_t>(sqlite3_column_bytes(stmt, column))));
+		}
+	}
 }
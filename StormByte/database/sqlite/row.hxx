@@ -1,44 +1,51 @@
 #pragma once
 
 #ifdef STORMBYTE_ENABLE_SQLITE
-	#include <StormByte/visibility.h>
+	#include <StormByte/database/sqlite/result.hxx>
 
-	#include <map>
 	#include <memory>
 	#include <vector>
 	#include <string>
 
+	class sqlite3_stmt;
 	namespace StormByte::Database::SQLite {
-		class Result;
+		/**
+		 * Lazy rows (see PreparedSTMT::SetLazyRows) decode each cell on first access
+		 * straight from the statement. Unread cells are only copied out if the row
+		 * is still referenced when the statement steps again, or when it is copied.
+		 */
 		class STORMBYTE_PUBLIC Row {
 			friend class PreparedSTMT;
 			public:
-				Row(const Row&)					= default;
-				Row(Row&&)						= default;
-				Row& operator=(const Row&)		= default;
-				Row& operator=(Row&&) noexcept	= default;
+				Row(const Row&);
+				Row(Row&&);
+				Row& operator=(const Row&);
+				Row& operator=(Row&&);
 				~Row() noexcept					= default;
 
 				size_t 							Columns() const noexcept;
-				std::shared_ptr<Result>			operator[](const size_t&);
-				const std::shared_ptr<Result>	operator[](const size_t&) const;
-				std::shared_ptr<Result> 		operator[](const std::string&);
-				const std::shared_ptr<Result>	operator[](const std::string&) const;
-				std::shared_ptr<Result> 		At(const size_t&);
-				const std::shared_ptr<Result>	At(const size_t&) const;
-				std::shared_ptr<Result> 		At(const std::string&);
-				const std::shared_ptr<Result>	At(const std::string&) const;
+				Result&							operator[](const size_t&);
+				const Result&					operator[](const size_t&) const;
+				Result& 						operator[](const std::string&);
+				const Result&					operator[](const std::string&) const;
+				Result& 						At(const size_t&);
+				const Result&					At(const size_t&) const;
+				Result& 						At(const std::string&);
+				const Result&					At(const std::string&) const;
 
 			private:
-				Row()							= default;
-				void add(std::string&&, std::shared_ptr<Result>);
-				std::shared_ptr<Result> get(const size_t&);
-				const std::shared_ptr<Result> get(const size_t&) const;
-				std::shared_ptr<Result> get(const std::string&);
-				const std::shared_ptr<Result> get(const std::string&) const;
+				// Column names are shared by every row a statement returns
+				Row(std::shared_ptr<const std::vector<std::string>>, sqlite3_stmt* = nullptr);
+				void add(Result&&);
+				size_t index(const std::string&) const;
+				Result& load(const size_t&) const;
+				void materialize() const;
+				static Result decode(sqlite3_stmt*, const int&);
 
-				std::map<std::string, std::shared_ptr<Result>> m_column_name_assoc;
-				std::map<size_t, std::shared_ptr<Result>> m_column_pos_assoc;
+				std::shared_ptr<const std::vector<std::string>> m_names;
+				mutable std::vector<Result> m_values;
+				mutable sqlite3_stmt* m_stmt;		// Only while the row is lazy and current
+				mutable std::vector<bool> m_decoded;
 		};
 	}
-#endif
\ No newline at end of file
+#endif
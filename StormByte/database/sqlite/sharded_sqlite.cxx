@@ -0,0 +1,149 @@
+#include <StormByte/database/sqlite/exception.hxx>
+#include <StormByte/database/sqlite/prepared_stmt.hxx>
+#include <StormByte/database/sqlite/sharded_sqlite.hxx>
+
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
+
+using namespace StormByte::Database::SQLite;
+
+namespace StormByte::Database::SQLite {
+	// Runs the tasks of one shard in order on its own thread
+	class ShardWorker {
+		public:
+			ShardWorker();
+			ShardWorker(const ShardWorker&)				= delete;
+			ShardWorker(ShardWorker&&)					= delete;
+			ShardWorker& operator=(const ShardWorker&)	= delete;
+			ShardWorker& operator=(ShardWorker&&)		= delete;
+			~ShardWorker() noexcept;
+
+			void submit(std::function<void()>&&);
+
+		private:
+			std::mutex m_mutex;
+			std::condition_variable m_cv;
+			std::deque<std::function<void()>> m_tasks;
+			bool m_stop;
+			std::thread m_thread;
+
+			void run();
+	};
+}
+
+Shard::Shard(const std::filesystem::path& file, const size_t& index, const std::string& schema):SQLite3(file), m_index(index) {
+	init_database();
+	if (!schema.empty())
+		silent_query(schema);
+}
+
+size_t Shard::Index() const noexcept {
+	return m_index;
+}
+
+ShardWorker::ShardWorker():m_stop(false) {
+	m_thread = std::thread(&ShardWorker::run, this);
+}
+
+ShardWorker::~ShardWorker() noexcept {
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_stop = true;
+	}
+	m_cv.notify_all();
+	if (m_thread.joinable())
+		m_thread.join();
+}
+
+void ShardWorker::submit(std::function<void()>&& task) {
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_tasks.push_back(std::move(task));
+	}
+	m_cv.notify_one();
+}
+
+void ShardWorker::run() {
+	while (true) {
+		std::function<void()> task;
+		{
+			std::unique_lock<std::mutex> lock(m_mutex);
+			m_cv.wait(lock, [this] { return m_stop || !m_tasks.empty(); });
+			// Pending tasks still run on shutdown so no future is left without a value
+			if (m_tasks.empty())
+				break;
+			task = std::move(m_tasks.front());
+			m_tasks.pop_front();
+		}
+		task();
+	}
+}
+
+ShardedSQLite::ShardedSQLite(const std::vector<std::filesystem::path>& files, const std::string& schema) {
+	if (files.empty())
+		throw ConnectionError("At least one shard is needed");
+
+	m_shards.reserve(files.size());
+	m_workers.reserve(files.size());
+	for (size_t i = 0; i < files.size(); i++) {
+		m_shards.push_back(std::unique_ptr<Shard>(new Shard(files[i], i, schema)));
+		m_workers.push_back(std::make_unique<ShardWorker>());
+	}
+}
+
+ShardedSQLite::~ShardedSQLite() noexcept {
+	// Workers are joined before the connections they use are closed
+	m_workers.clear();
+	m_shards.clear();
+}
+
+size_t ShardedSQLite::Shards() const noexcept {
+	return m_shards.size();
+}
+
+size_t ShardedSQLite::ShardOf(const int64_t& key) const noexcept {
+	// splitmix64 finalizer, sequential keys spread evenly
+	uint64_t hash = static_cast<uint64_t>(key);
+	hash = (hash ^ (hash >> 30)) * 0xbf58476d1ce4e5b9ULL;
+	hash = (hash ^ (hash >> 27)) * 0x94d049bb133111ebULL;
+	hash ^= hash >> 31;
+	return static_cast<size_t>(hash % m_shards.size());
+}
+
+size_t ShardedSQLite::ShardOf(const std::string_view& key) const noexcept {
+	// FNV-1a, unlike std::hash it is the same on every platform and run
+	uint64_t hash = 0xcbf29ce484222325ULL;
+	for (const char& c: key) {
+		hash ^= static_cast<unsigned char>(c);
+		hash *= 0x100000001b3ULL;
+	}
+	return static_cast<size_t>(hash % m_shards.size());
+}
+
+void ShardedSQLite::submit(const size_t& index, std::function<void()>&& task) {
+	m_workers[index]->submit(std::move(task));
+}
+
+ColumnBatch ShardedSQLite::Query(const std::string& query) {
+	std::vector<ColumnBatch> batches = RunAll([&query](Shard& shard) {
+		std::shared_ptr<PreparedSTMT> stmt = shard.get_prepared(query);
+		if (!stmt)
+			stmt = shard.prepare_sentence(query, query);
+		try {
+			ColumnBatch batch = stmt->Fetch();
+			stmt->Reset();
+			return batch;
+		}
+		catch (...) {
+			stmt->Reset();
+			throw;
+		}
+	});
+
+	ColumnBatch result = std::move(batches.front());
+	for (size_t i = 1; i < batches.size(); i++)
+		result.append(batches[i]);
+	return result;
+}
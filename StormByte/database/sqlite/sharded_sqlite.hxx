@@ -0,0 +1,133 @@
+#pragma once
+
+#ifdef STORMBYTE_ENABLE_SQLITE
+	#include <StormByte/database/sqlite/column_batch.hxx>
+	#include <StormByte/database/sqlite/sqlite3.hxx>
+
+	#include <cstdint>
+	#include <filesystem>
+	#include <functional>
+	#include <future>
+	#include <memory>
+	#include <string>
+	#include <string_view>
+	#include <type_traits>
+	#include <vector>
+
+	namespace StormByte::Database::SQLite {
+		class ShardWorker;
+
+		// Connection to one shard, only used from that shard's thread
+		class STORMBYTE_PUBLIC Shard final: public SQLite3 {
+			friend class ShardedSQLite;
+			public:
+				Shard(const Shard&)					= delete;
+				Shard(Shard&&)						= delete;
+				Shard& operator=(const Shard&)		= delete;
+				Shard& operator=(Shard&&)			= delete;
+				~Shard() noexcept override			= default;
+
+				size_t 							Index() const noexcept;
+
+				using SQLite3::prepare_sentence;
+				using SQLite3::get_prepared;
+				using SQLite3::silent_query;
+				using SQLite3::transaction;
+				using SQLite3::cached_query;
+
+			private:
+				Shard(const std::filesystem::path&, const size_t&, const std::string&);
+				void post_init_action() noexcept override {}
+
+				size_t m_index;
+		};
+
+		/**
+		 * Hash partitions keys across one database file per shard, each with its
+		 * own connection and thread so writes to different shards run in parallel.
+		 * Point operations go to the shard owning the key, fan out operations run
+		 * on every shard at once. Key hashing is stable across runs and platforms
+		 * but changing the number of shards moves keys between them.
+		 */
+		class STORMBYTE_PUBLIC ShardedSQLite {
+			public:
+				// The schema script runs on every shard when it is opened, so it should be idempotent
+				ShardedSQLite(const std::vector<std::filesystem::path>&, const std::string& = "");
+				ShardedSQLite(const ShardedSQLite&)				= delete;
+				ShardedSQLite(ShardedSQLite&&)					= delete;
+				ShardedSQLite& operator=(const ShardedSQLite&)	= delete;
+				ShardedSQLite& operator=(ShardedSQLite&&)		= delete;
+				~ShardedSQLite() noexcept;
+
+				size_t 							Shards() const noexcept;
+				size_t 							ShardOf(const int64_t&) const noexcept;
+				size_t 							ShardOf(const std::string_view&) const noexcept;
+
+				// Runs f(Shard&) on the shard owning the key
+				template<typename K, typename F> auto	Run(const K&, F&&) -> std::future<std::invoke_result_t<F&, Shard&>>;
+				template<typename F> auto				RunOn(const size_t&, F&&) -> std::future<std::invoke_result_t<F&, Shard&>>;
+				// Runs f(Shard&) on every shard in parallel and returns their results in shard order
+				template<typename F> auto				RunAll(F&&);
+				// Every shard's rows one after another, ORDER BY and LIMIT only apply within each shard
+				ColumnBatch								Query(const std::string&);
+				// Runs f(Shard&) on every shard and folds the results into init with merge(T, R)
+				template<typename T, typename F, typename M> T	Reduce(F&&, T, M&&);
+
+			private:
+				std::vector<std::unique_ptr<Shard>> m_shards;
+				std::vector<std::unique_ptr<ShardWorker>> m_workers;
+
+				void submit(const size_t&, std::function<void()>&&);
+
+				template<typename K> size_t shard_of(const K& key) const noexcept {
+					if constexpr (std::is_integral_v<K>)
+						return ShardOf(static_cast<int64_t>(key));
+					else
+						return ShardOf(std::string_view(key));
+				}
+		};
+
+		template<typename K, typename F> auto ShardedSQLite::Run(const K& key, F&& f) -> std::future<std::invoke_result_t<F&, Shard&>> {
+			return RunOn(shard_of(key), std::forward<F>(f));
+		}
+
+		template<typename F> auto ShardedSQLite::RunOn(const size_t& index, F&& f) -> std::future<std::invoke_result_t<F&, Shard&>> {
+			using R = std::invoke_result_t<F&, Shard&>;
+			Shard* shard = m_shards.at(index).get();
+			// std::function needs a copyable target
+			auto task = std::make_shared<std::packaged_task<R()>>([shard, f = std::forward<F>(f)]() mutable { return f(*shard); });
+			std::future<R> result = task->get_future();
+			submit(index, [task] { (*task)(); });
+			return result;
+		}
+
+		template<typename F> auto ShardedSQLite::RunAll(F&& f) {
+			using R = std::invoke_result_t<F&, Shard&>;
+			std::vector<std::future<R>> futures;
+			futures.reserve(m_shards.size());
+			for (size_t i = 0; i < m_shards.size(); i++)
+				futures.push_back(RunOn(i, [&f](Shard& shard) { return f(shard); }));
+			// f is referenced by every task, all of them must finish before any error propagates
+			for (auto& future: futures)
+				future.wait();
+
+			if constexpr (std::is_void_v<R>) {
+				for (auto& future: futures)
+					future.get();
+			}
+			else {
+				std::vector<R> results;
+				results.reserve(futures.size());
+				for (auto& future: futures)
+					results.push_back(future.get());
+				return results;
+			}
+		}
+
+		template<typename T, typename F, typename M> T ShardedSQLite::Reduce(F&& f, T init, M&& merge) {
+			for (auto& result: RunAll(std::forward<F>(f)))
+				init = merge(std::move(init), std::move(result));
+			return init;
+		}
+	}
+#endif
@@ -1,81 +1,931 @@
+#include <StormByte/database/sqlite/blob_stream.hxx>
+#include <StormByte/database/sqlite/checkpointer.hxx>
+#include <StormByte/database/sqlite/commit_tracker.hxx>
+#include <StormByte/database/sqlite/deadline.hxx>
 #include <StormByte/database/sqlite/exception.hxx>
+#include <StormByte/database/sqlite/group_commit.hxx>
 #include <StormByte/database/sqlite/prepared_stmt.hxx>
+#include <StormByte/database/sqlite/preparer.hxx>
+#include <StormByte/database/sqlite/result.hxx>
 #include <StormByte/database/sqlite/sqlite3.hxx>
+#include <StormByte/database/sqlite/uring_vfs.hxx>
 
+#include <optional>
 #include <sqlite3.h>
 
 using namespace StormByte::Database::SQLite;
 
-SQLite3::SQLite3(const std::filesystem::path& dbfile):m_database_file(dbfile) {}
+namespace {
+	#ifdef SQLITE_ENABLE_PREUPDATE_HOOK
+	Result to_result(sqlite3_value* value) {
+		switch(sqlite3_value_type(value)) {
+			case SQLITE_INTEGER:
+				return Result(static_cast<int64_t>(sqlite3_value_int64(value)));
 
-SQLite3::SQLite3(std::filesystem::path&& dbfile):m_database_file(std::move(dbfile)) {}
+			case SQLITE_FLOAT:
+				return Result(sqlite3_value_double(value));
+
+			case SQLITE_NULL:
+				return Result(nullptr);
+
+			default: {
+				const char* data = static_cast<const char*>(sqlite3_value_blob(value));
+				return Result(std::string_view(data ? data : "", static_cast<size_t>(sqlite3_value_bytes(value))));
+			}
+		}
+	}
+
+	std::vector<Result> row_values(sqlite3* db, const bool& old_row) {
+		std::vector<Result> values;
+		const int count = sqlite3_preupdate_count(db);
+		values.reserve(static_cast<size_t>(count));
+		for (int i = 0; i < count; i++) {
+			sqlite3_value* value = nullptr;
+			if (old_row)
+				sqlite3_preupdate_old(db, i, &value);
+			else
+				sqlite3_preupdate_new(db, i, &value);
+			values.push_back(value ? to_result(value) : Result(nullptr));
+		}
+		return values;
+	}
+	#endif
+
+	// Prefixed so that the savepoints of Transaction guards do not clash with the application's
+	std::string savepoint_name(const size_t& savepoint) {
+		return "stormbyte_sp" + std::to_string(savepoint);
+	}
+
+	std::string identifier(const std::string& name) {
+		std::string quoted = "\"";
+		for (const char& c: name) {
+			quoted += c;
+			if (c == '"')
+				quoted += c;
+		}
+		return quoted + "\"";
+	}
+
+	const char* profile_pragmas(const Profile& profile) noexcept {
+		// page_size only takes effect on a new database, before it switches to WAL
+		switch(profile) {
+			case Profile::ReadHeavy:
+				return	"PRAGMA page_size = 4096; PRAGMA journal_mode = WAL; PRAGMA synchronous = NORMAL;"
+						"PRAGMA mmap_size = 268435456; PRAGMA cache_size = -65536; PRAGMA temp_store = MEMORY;";
+
+			case Profile::WriteHeavy:
+				return	"PRAGMA page_size = 8192; PRAGMA journal_mode = WAL; PRAGMA synchronous = NORMAL;"
+						"PRAGMA mmap_size = 67108864; PRAGMA cache_size = -32768; PRAGMA temp_store = MEMORY;";
+
+			case Profile::Ephemeral:
+				return	"PRAGMA page_size = 4096; PRAGMA journal_mode = MEMORY; PRAGMA synchronous = OFF;"
+						"PRAGMA mmap_size = 0; PRAGMA cache_size = -16384; PRAGMA temp_store = MEMORY;";
+
+			default:
+				return nullptr;
+		}
+	}
+}
+
+SQLite3::SQLite3(const std::filesystem::path& dbfile):m_database_file(dbfile), m_vfs(nullptr), m_database(nullptr), m_savepoints(0), m_begin_locks(0),
+m_transaction_mutex(std::make_shared<std::recursive_mutex>()), m_busy_handler(std::make_shared<BusyHandler>()), m_tracker(std::make_shared<CommitTracker>()),
+m_statement_totals(std::make_shared<StatementTotals>()), m_query_plan_check(false), m_query_plan_logger(nullptr), m_query_plan_level(Log::Level::Warning), m_track_external_changes(false), m_data_version(-1) {}
+
+SQLite3::SQLite3(std::filesystem::path&& dbfile):m_database_file(std::move(dbfile)), m_vfs(nullptr), m_database(nullptr), m_savepoints(0), m_begin_locks(0),
+m_transaction_mutex(std::make_shared<std::recursive_mutex>()), m_busy_handler(std::make_shared<BusyHandler>()), m_tracker(std::make_shared<CommitTracker>()),
+m_statement_totals(std::make_shared<StatementTotals>()), m_query_plan_check(false), m_query_plan_logger(nullptr), m_query_plan_level(Log::Level::Warning), m_track_external_changes(false), m_data_version(-1) {}
+
+SQLite3::SQLite3(SQLite3&& db) noexcept = default;
+
+SQLite3& SQLite3::operator=(SQLite3&& db) noexcept = default;
 
 SQLite3::~SQLite3() noexcept { close_database(); }
 
-void SQLite3::init_database() {
+void SQLite3::init_database(const Profile& profile) {
 	// This is undefined behavior if called more than once for the same object
 	// Windows needs this string intermediate conversion
-	if (sqlite3_open(m_database_file.string().c_str(), &m_database) != SQLITE_OK) {
+	// URI names allow shared cache memory databases like file:name?mode=memory&cache=shared
+	if (sqlite3_open_v2(m_database_file.string().c_str(), &m_database, SQLITE_OPEN_READWRITE | SQLITE_OPEN_CREATE | SQLITE_OPEN_URI | SQLITE_OPEN_FULLMUTEX, m_vfs) != SQLITE_OK) {
 		std::string message = "Cannot open database " + m_database_file.string() + ": " + last_error(); // SQLite3 handles internally freeing message's memory
 		close_database(); // Need to close database here as exception throwing might skip destructor
         throw ConnectionError(std::move(message));
     }
+	if (m_busy_handler->IsEnabled())
+		sqlite3_busy_handler(m_database, &BusyHandler::Callback, m_busy_handler.get());
+	if (m_profiler)
+		sqlite3_trace_v2(m_database, SQLITE_TRACE_STMT | SQLITE_TRACE_PROFILE, &Profiler::Callback, m_profiler.get());
+	install_hooks();
+	if (const char* pragmas = profile_pragmas(profile)) {
+		try {
+			silent_query(pragmas);
+		}
+		catch (...) {
+			close_database();
+			throw;
+		}
+	}
 	enable_foreign_keys();
 	this->post_init_action();
 }
 
+bool SQLite3::use_uring_vfs() noexcept {
+	if (!URingVFS::Register())
+		return false;
+	m_vfs = URingVFS::NAME;
+	return true;
+}
+
 void SQLite3::close_database() {
 	if (m_database) {
+		disable_background_checkpoint();
+		disable_group_commit();
+		stop_backup(true);
+		m_preparer.reset();
 		m_prepared.clear();
-		sqlite3_close(m_database);
+		m_internal_prepared.clear();
+		m_scripts.clear();
+		// Outstanding blob streams or statements keep the connection alive until they are released
+		sqlite3_close_v2(m_database);
 		m_database = nullptr;
 	}
 }
 
 void SQLite3::enable_foreign_keys() {
-	silent_query("PRAGMA foreign_keys = OFF");
+	silent_query("PRAGMA foreign_keys = ON");
 }
 
 void SQLite3::begin_transaction() {
-	silent_query("BEGIN TRANSACTION");
+	begin_locked("BEGIN TRANSACTION");
 }
 
 void SQLite3::begin_exclusive_transaction() {
-	silent_query("BEGIN EXCLUSIVE TRANSACTION");
+	begin_locked("BEGIN EXCLUSIVE TRANSACTION");
 }
 
 void SQLite3::commit_transaction() {
-	silent_query("COMMIT");
+	std::lock_guard<std::recursive_mutex> lock(*m_transaction_mutex);
+	execute_internal("COMMIT");
+	m_savepoints = 0;
+	release_begin_lock();
 }
 
 void SQLite3::rollback_transaction() {
-	silent_query("ROLLBACK");
+	std::lock_guard<std::recursive_mutex> lock(*m_transaction_mutex);
+	try {
+		execute_internal("ROLLBACK");
+	}
+	catch (...) {
+		// The transaction may already be gone, rolled back by SQLite after an error
+		release_begin_lock();
+		throw;
+	}
+	m_savepoints = 0;
+	release_begin_lock();
+}
+
+Transaction SQLite3::transaction(const Transaction::Mode& mode) {
+	std::unique_lock<std::recursive_mutex> lock(*m_transaction_mutex);
+	if (sqlite3_get_autocommit(m_database)) {
+		switch(mode) {
+			case Transaction::Mode::Immediate:
+				execute_internal("BEGIN IMMEDIATE TRANSACTION");
+				break;
+
+			case Transaction::Mode::Exclusive:
+				execute_internal("BEGIN EXCLUSIVE TRANSACTION");
+				break;
+
+			default:
+				execute_internal("BEGIN TRANSACTION");
+				break;
+		}
+		m_savepoints = 0;
+		return Transaction(*this, 0, std::move(lock));
+	}
+	else {
+		execute_internal("SAVEPOINT " + savepoint_name(m_savepoints + 1));
+		m_savepoints++;
+		return Transaction(*this, m_savepoints, std::move(lock));
+	}
+}
+
+void SQLite3::begin_locked(const std::string& query) {
+	// Held until commit_transaction or rollback_transaction, like a Transaction guard holds it
+	std::unique_lock<std::recursive_mutex> lock(*m_transaction_mutex);
+	execute_internal(query);
+	lock.release();
+	m_begin_locks++;
+}
+
+void SQLite3::release_begin_lock() noexcept {
+	if (m_begin_locks > 0) {
+		m_begin_locks--;
+		m_transaction_mutex->unlock();
+	}
+}
+
+void SQLite3::enable_background_checkpoint(const std::chrono::milliseconds& interval, const size_t& wal_limit) {
+	disable_background_checkpoint();
+	const char* file = sqlite3_db_filename(m_database, "main");
+	if (!file || !*file)
+		throw ConnectionError("Background checkpoints need a database file");
+
+	sqlite3_stmt* stmt = nullptr;
+	bool wal = false;
+	if (sqlite3_prepare_v2(m_database, "PRAGMA journal_mode", -1, &stmt, nullptr) == SQLITE_OK && sqlite3_step(stmt) == SQLITE_ROW) {
+		const unsigned char* mode = sqlite3_column_text(stmt, 0);
+		wal = mode && std::string(reinterpret_cast<const char*>(mode)) == "wal";
+	}
+	sqlite3_finalize(stmt);
+	if (!wal)
+		throw ConnectionError("Background checkpoints need journal_mode = WAL");
+
+	// Truncation briefly holds the write lock, writers have to wait for it instead of failing
+	if (!m_busy_handler->IsEnabled())
+		set_busy_policy(BusyPolicy());
+	m_checkpointer = std::make_unique<Checkpointer>(file, interval, wal_limit);
+	sqlite3_wal_autocheckpoint(m_database, 0);
+}
+
+void SQLite3::disable_background_checkpoint() noexcept {
+	if (m_checkpointer) {
+		m_checkpointer.reset();
+		sqlite3_wal_autocheckpoint(m_database, 1000); // SQLite default
+	}
+}
+
+void SQLite3::enable_group_commit(const std::chrono::milliseconds& window, const size_t& max_batch) {
+	disable_group_commit();
+	m_group_commit = std::make_unique<GroupCommit>(*this, window, max_batch);
+}
+
+void SQLite3::disable_group_commit() noexcept {
+	// Pending units are committed before the committer thread exits
+	m_group_commit.reset();
+}
+
+std::future<void> SQLite3::group_transaction(std::function<void()>&& work) {
+	std::promise<void> promise;
+	if (m_group_commit) {
+		// Getting the lock with a transaction open means this thread holds it, the committer would wait forever
+		std::unique_lock<std::recursive_mutex> lock(*m_transaction_mutex, std::try_to_lock);
+		if (!lock || sqlite3_get_autocommit(m_database))
+			return m_group_commit->submit(std::move(work));
+		promise.set_exception(std::make_exception_ptr(QueryError("Group transactions can not be submitted while this thread has a transaction open")));
+		return promise.get_future();
+	}
+
+	try {
+		Transaction transaction = this->transaction(Transaction::Mode::Immediate);
+		work();
+		transaction.Commit();
+		promise.set_value();
+	}
+	catch (...) {
+		promise.set_exception(std::current_exception());
+	}
+	return promise.get_future();
 }
 
 std::shared_ptr<PreparedSTMT> SQLite3::prepare_sentence(const std::string& name, const std::string& query) {
 	std::shared_ptr<PreparedSTMT> stmt = std::make_shared<PreparedSTMT>(PreparedSTMT(query));
-	sqlite3_prepare_v2( m_database, stmt->m_query.c_str(), static_cast<int>(stmt->m_query.length()), &stmt->m_stmt, nullptr);
-	if (!stmt->m_stmt)
-		throw QueryError("Prepared sentence " + name + " can not be loaded\n" + last_error());
-	else
-		m_prepared.insert({ name, stmt });
+	{
+		const Preparer::ErrorLock lock(m_database);
+		std::shared_ptr<StatementTables> tables;
+		{
+			const CommitTracker::Recording recording(*m_tracker, tables);
+			sqlite3_prepare_v2( m_database, stmt->m_query.c_str(), static_cast<int>(stmt->m_query.length()), &stmt->m_stmt, nullptr);
+		}
+		stmt->m_tables = std::move(tables);
+		if (!stmt->m_stmt)
+			throw QueryError("Prepared sentence " + name + " can not be loaded\n" + last_error());
+	}
+	return add_sentence(name, std::move(stmt));
+}
+
+void SQLite3::declare_sentence(const std::string& name, const std::string& query) {
+	m_declared.insert_or_assign(name, query);
+}
+
+void SQLite3::prepare_declared(const bool& background) {
+	// Whatever an earlier run compiled and nobody took is still declared, so it is queued again
+	m_preparer.reset();
+	if (background) {
+		// Otherwise they stay declared, compiled on first use
+		if (!m_declared.empty() && Preparer::Supported(m_database))
+			m_preparer = std::make_unique<Preparer>(m_database, std::deque<std::pair<std::string, std::string>>(m_declared.begin(), m_declared.end()));
+	}
+	else {
+		while (!m_declared.empty()) {
+			const auto declared = *m_declared.begin();
+			prepare_sentence(declared.first, declared.second);
+		}
+	}
+}
+
+std::shared_ptr<PreparedSTMT> SQLite3::add_sentence(const std::string& name, std::shared_ptr<PreparedSTMT>&& stmt) {
+	attach_statement(*stmt);
+	stmt->m_statement_totals = m_statement_totals;
+	stmt->index_parameters();
+	m_prepared.insert({ name, stmt });
+	m_declared.erase(name);
+	if (m_query_plan_check)
+		check_query_plan(name, stmt->m_query);
 	return stmt;
 }
 
-std::shared_ptr<PreparedSTMT> SQLite3::get_prepared(const std::string& name) {
-	std::shared_ptr<PreparedSTMT> stmt = nullptr;
-	if (m_prepared.find(name) != m_prepared.end())
-		stmt = m_prepared.at(name);
+std::shared_ptr<PreparedSTMT> SQLite3::prepare(const std::string& query) {
+	std::shared_ptr<PreparedSTMT> stmt = std::make_shared<PreparedSTMT>(PreparedSTMT(query));
+	{
+		const Preparer::ErrorLock lock(m_database);
+		std::shared_ptr<StatementTables> tables;
+		{
+			const CommitTracker::Recording recording(*m_tracker, tables);
+			sqlite3_prepare_v3(m_database, stmt->m_query.c_str(), static_cast<int>(stmt->m_query.length()), SQLITE_PREPARE_PERSISTENT, &stmt->m_stmt, nullptr);
+		}
+		stmt->m_tables = std::move(tables);
+		if (!stmt->m_stmt)
+			throw QueryError("Internal sentence " + query + " can not be loaded\n" + last_error());
+	}
+	// Only used for statements the connection keeps
+	attach_statement(*stmt);
+	stmt->m_statement_totals = m_statement_totals;
+	stmt->index_parameters();
 	return stmt;
 }
 
-void SQLite3::silent_query(const std::string& query) {
-	char* error;
-	if (sqlite3_exec(m_database, query.c_str(), nullptr, nullptr, &error) != SQLITE_OK) {
-		std::string err { error };
-		sqlite3_free(error);
-		throw QueryError(std::move(err));
+void SQLite3::attach_statement(PreparedSTMT& stmt) const noexcept {
+	stmt.m_busy_handler = m_busy_handler;
+	stmt.m_tracker = m_tracker;
+	stmt.m_transaction_mutex = m_transaction_mutex;
+}
+
+void SQLite3::execute_internal(const std::string& query) {
+	std::lock_guard<std::recursive_mutex> lock(*m_transaction_mutex);
+	auto it = m_internal_prepared.find(query);
+	if (it == m_internal_prepared.end())
+		it = m_internal_prepared.insert({ query, prepare(query) }).first;
+	it->second->Execute();
+}
+
+void SQLite3::run_script_statement(PreparedSTMT& stmt, const size_t& index, const std::function<void(const size_t&, const Row&)>& on_row) {
+	try {
+		if (on_row) {
+			while (std::shared_ptr<Row> row = stmt.Step())
+				on_row(index, *row);
+		}
+		else {
+			int rc;
+			while ((rc = stmt.step()) == SQLITE_ROW);
+			if (rc != SQLITE_DONE)
+				stmt.throw_error(rc);
+		}
+	}
+	catch (...) {
+		stmt.Reset();
+		throw;
+	}
+	stmt.Reset();
+}
+
+void SQLite3::end_transaction(const size_t& savepoint, const bool& commit) {
+	std::lock_guard<std::recursive_mutex> lock(*m_transaction_mutex);
+	if (savepoint == 0) {
+		if (commit && m_savepoints > 0)
+			throw QueryError("Can not commit a transaction with " + std::to_string(m_savepoints) + " savepoints still open");
+		m_savepoints = 0;
+		execute_internal(commit ? "COMMIT" : "ROLLBACK");
+	}
+	else {
+		if (savepoint != m_savepoints)
+			throw QueryError("Savepoint " + savepoint_name(savepoint) + " is not the innermost one");
+		const std::string name = savepoint_name(savepoint);
+		m_savepoints--;
+		// The change feed and the query cache follow savepoints through the commit tracker
+		if (!commit)
+			execute_internal("ROLLBACK TO " + name);
+		execute_internal("RELEASE " + name);
+	}
+}
+
+std::shared_ptr<PreparedSTMT> SQLite3::get_prepared(const std::string& name) {
+	auto it = m_prepared.find(name);
+	if (it != m_prepared.end())
+		return it->second;
+
+	auto declared = m_declared.find(name);
+	if (declared == m_declared.end())
+		return nullptr;
+	const std::string query = declared->second;
+	if (m_preparer) {
+		if (sqlite3_stmt* compiled = m_preparer->take(name)) {
+			std::shared_ptr<PreparedSTMT> stmt = std::make_shared<PreparedSTMT>(PreparedSTMT(query));
+			stmt->m_stmt = compiled;
+			return add_sentence(name, std::move(stmt));
+		}
+	}
+	return prepare_sentence(name, query);
+}
+
+std::map<std::string, StatementStatus> SQLite3::statement_status(const bool& reset) {
+	// Internal statements are added by the group committer and imports under the same lock
+	std::lock_guard<std::recursive_mutex> lock(*m_transaction_mutex);
+	// Finalized statements already added theirs, the rest still hold what they counted
+	std::map<std::string, StatementStatus> status = m_statement_totals->totals(reset);
+	const auto add = [&status, &reset](const std::shared_ptr<PreparedSTMT>& stmt) {
+		status[stmt->m_query] += stmt->take_status(reset);
+	};
+	for (const auto& prepared: m_prepared)
+		add(prepared.second);
+	for (const auto& prepared: m_internal_prepared)
+		add(prepared.second);
+	for (const auto& script: m_scripts) {
+		for (const std::shared_ptr<PreparedSTMT>& stmt: script.second)
+			add(stmt);
+	}
+	return status;
+}
+
+ConnectionMemory SQLite3::memory_status(const bool& reset) const noexcept {
+	ConnectionMemory memory;
+	const auto status = [this, &reset](const int& op, size_t& current, size_t* highest = nullptr) {
+		int value = 0, high_water = 0;
+		if (sqlite3_db_status(m_database, op, &value, &high_water, reset ? 1 : 0) == SQLITE_OK) {
+			current = static_cast<size_t>(value);
+			if (highest)
+				*highest = static_cast<size_t>(high_water);
+		}
+	};
+	status(SQLITE_DBSTATUS_CACHE_USED, memory.cache_used);
+	status(SQLITE_DBSTATUS_SCHEMA_USED, memory.schema_used);
+	status(SQLITE_DBSTATUS_STMT_USED, memory.statement_used);
+	status(SQLITE_DBSTATUS_LOOKASIDE_USED, memory.lookaside_used, &memory.lookaside_high_water);
+	// Only the high water mark is meaningful for misses
+	size_t unused = 0;
+	status(SQLITE_DBSTATUS_LOOKASIDE_MISS_FULL, unused, &memory.lookaside_misses);
+	return memory;
+}
+
+void SQLite3::enable_query_plan_check(Log::Logger* logger, const Log::Level& level) {
+	m_query_plan_check = true;
+	m_query_plan_logger = logger;
+	m_query_plan_level = level;
+}
+
+void SQLite3::disable_query_plan_check() noexcept {
+	m_query_plan_check = false;
+	m_query_plan_logger = nullptr;
+}
+
+const std::map<std::string, std::vector<std::string>>& SQLite3::query_plan_warnings() const noexcept {
+	return m_query_plan_warnings;
+}
+
+void SQLite3::check_query_plan(const std::string& name, const std::string& query) {
+	sqlite3_stmt* plan = nullptr;
+	const std::string explain = "EXPLAIN QUERY PLAN " + query;
+	if (sqlite3_prepare_v2(m_database, explain.c_str(), static_cast<int>(explain.length()), &plan, nullptr) != SQLITE_OK) {
+		sqlite3_finalize(plan);
+		return; // Not every statement can be explained, this is only a development aid
+	}
+
+	while (sqlite3_step(plan) == SQLITE_ROW) {
+		const unsigned char* text = sqlite3_column_text(plan, 3);
+		const std::string detail = text ? reinterpret_cast<const char*>(text) : "";
+		// "SCAN t" (or "SCAN TABLE t" before 3.36) walks the whole table, "SCAN t USING INDEX" does not
+		// and virtual tables ("SCAN t VIRTUAL TABLE INDEX n:") choose their own plan
+		if (detail.rfind("SCAN ", 0) == 0 && detail.find(" USING ") == std::string::npos
+			&& detail.find("CONSTANT ROW") == std::string::npos && detail.find("SCAN (") == std::string::npos
+			&& detail.find("VIRTUAL TABLE INDEX") == std::string::npos) {
+			m_query_plan_warnings[name].push_back(detail);
+			if (m_query_plan_logger)
+				*m_query_plan_logger << m_query_plan_level << "Prepared sentence " + name + " does a full scan (" + detail + "): " + query
+					<< Log::Logger::endl;
+		}
+	}
+	sqlite3_finalize(plan);
+}
+
+void SQLite3::silent_query(const std::string& query, const std::chrono::milliseconds& timeout) {
+	// Statement by statement, as sqlite3_exec would, so that each one is settled like any other
+	if (timeout.count() > 0) {
+		Deadline deadline(m_database, std::chrono::steady_clock::now() + timeout, *m_busy_handler);
+		try {
+			execute_script(query, nullptr, false);
+		}
+		catch (const Exception&) {
+			// Interrupted, or failed waiting for a lock once the deadline passed
+			if (deadline.Expired())
+				throw QueryInterrupted("Query exceeded its " + std::to_string(timeout.count()) + "ms deadline");
+			throw;
+		}
+	}
+	else
+		execute_script(query, nullptr, false);
+}
+
+size_t SQLite3::execute_script(const std::string& script, const std::function<void(const size_t&, const Row&)>& on_row, const bool& single_transaction, const bool& cache) {
+	std::optional<Transaction> guard;
+	if (single_transaction)
+		guard.emplace(transaction(Transaction::Mode::Immediate));
+
+	size_t executed = 0;
+	auto cached = cache ? m_scripts.find(script) : m_scripts.end();
+	if (cached != m_scripts.end()) {
+		for (const std::shared_ptr<PreparedSTMT>& stmt: cached->second)
+			run_script_statement(*stmt, executed++, on_row);
+	}
+	else {
+		// Statements are compiled one at a time as the earlier ones may create what the later ones use
+		std::vector<std::shared_ptr<PreparedSTMT>> compiled;
+		const char* tail = script.c_str();
+		const char* const end = tail + script.length();
+		while (tail < end) {
+			sqlite3_stmt* raw = nullptr;
+			const char* next = nullptr;
+			std::shared_ptr<StatementTables> tables;
+			{
+				const Preparer::ErrorLock lock(m_database);
+				int rc;
+				{
+					// Recorded with the statement, so it goes away with a statement run only once
+					const CommitTracker::Recording recording(*m_tracker, tables);
+					rc = sqlite3_prepare_v3(m_database, tail, static_cast<int>(end - tail), cache ? SQLITE_PREPARE_PERSISTENT : 0, &raw, &next);
+				}
+				if (rc != SQLITE_OK)
+					throw QueryError("Script statement " + std::to_string(executed + 1) + " can not be loaded\n" + last_error());
+			}
+			tail = next;
+			// Comments and whitespace compile to nothing
+			if (!raw)
+				continue;
+			std::shared_ptr<PreparedSTMT> stmt = std::make_shared<PreparedSTMT>(PreparedSTMT(sqlite3_sql(raw)));
+			stmt->m_stmt = raw;
+			stmt->m_tables = std::move(tables);
+			attach_statement(*stmt);
+			// Statements run only once are not counted, each SQL text would stay in the totals forever
+			if (cache)
+				stmt->m_statement_totals = m_statement_totals;
+			run_script_statement(*stmt, executed++, on_row);
+			if (cache)
+				compiled.push_back(std::move(stmt));
+		}
+		if (cache)
+			m_scripts.insert_or_assign(script, std::move(compiled));
+	}
+
+	if (guard)
+		guard->Commit();
+	return executed;
+}
+
+void SQLite3::cancel() noexcept {
+	if (m_database)
+		sqlite3_interrupt(m_database);
+	m_busy_handler->cancel();
+}
+
+std::shared_ptr<QueryCache> SQLite3::enable_query_cache(const size_t& max_entries, const bool& track_external_changes) {
+	m_query_cache = std::make_shared<QueryCache>(max_entries);
+	m_track_external_changes = track_external_changes;
+	m_data_version = -1;
+	install_hooks();
+	return m_query_cache;
+}
+
+void SQLite3::disable_query_cache() noexcept {
+	m_query_cache.reset();
+	install_hooks();
+}
+
+std::shared_ptr<ChangeFeed> SQLite3::enable_change_feed(const size_t& capacity, const bool& values, const std::vector<std::string>& tables) {
+	if (!sqlite3_get_autocommit(m_database))
+		throw QueryError("Change feed can not be enabled inside a transaction");
+	disable_change_feed();
+	#ifdef SQLITE_ENABLE_PREUPDATE_HOOK
+	m_change_feed = std::make_shared<ChangeFeed>(capacity, values, tables);
+	#else
+	(void)values;
+	m_change_feed = std::make_shared<ChangeFeed>(capacity, false, tables);
+	#endif
+	install_hooks();
+	return m_change_feed;
+}
+
+void SQLite3::disable_change_feed() noexcept {
+	if (m_change_feed) {
+		m_change_feed->Close();
+		m_change_feed.reset();
+		install_hooks();
+	}
+}
+
+std::shared_ptr<const ColumnBatch> SQLite3::cached_query(const std::string& name) {
+	std::shared_ptr<PreparedSTMT> stmt = get_prepared(name);
+	if (!stmt)
+		throw QueryError("Prepared sentence " + name + " does not exist");
+	return cached_query(*stmt);
+}
+
+std::shared_ptr<const ColumnBatch> SQLite3::cached_query(PreparedSTMT& stmt) {
+	std::shared_ptr<const ColumnBatch> result = nullptr;
+	try {
+		// Results are keyed by the SQL and the exact values bound to it
+		const std::optional<std::string> key = m_query_cache ? stmt.binding_key() : std::nullopt;
+		if (key) {
+			if (m_track_external_changes)
+				check_external_changes();
+
+			result = m_query_cache->Get(*key);
+			if (!result) {
+				const std::vector<std::string>& tables = m_tracker->tables(stmt).read;
+				const uint64_t epoch = m_query_cache->Epoch();
+				result = std::make_shared<const ColumnBatch>(stmt.Fetch());
+				m_query_cache->Put(*key, result, tables, epoch);
+			}
+		}
+		else
+			result = std::make_shared<const ColumnBatch>(stmt.Fetch());
+	}
+	catch (...) {
+		stmt.Reset();
+		throw;
+	}
+	stmt.Reset();
+	return result;
+}
+
+void SQLite3::set_busy_policy(const BusyPolicy& policy) {
+	m_busy_handler->SetPolicy(policy);
+	if (m_database)
+		sqlite3_busy_handler(m_database, &BusyHandler::Callback, m_busy_handler.get());
+}
+
+BusyStatistics SQLite3::busy_statistics() const noexcept {
+	return m_busy_handler->Statistics();
+}
+
+void SQLite3::reset_busy_statistics() noexcept {
+	m_busy_handler->ResetStatistics();
+}
+
+void SQLite3::unregister_function(const std::string& name, const int& arguments) {
+	const Preparer::ErrorLock lock(m_database);
+	if (sqlite3_create_function_v2(m_database, name.c_str(), arguments, SQLITE_UTF8, nullptr, nullptr, nullptr, nullptr, nullptr) != SQLITE_OK)
+		throw QueryError("Can not unregister function " + name + ": " + last_error());
+}
+
+void SQLite3::unregister_table(const std::string& name) {
+	// A null module drops the existing one
+	const Preparer::ErrorLock lock(m_database);
+	if (sqlite3_create_module_v2(m_database, name.c_str(), nullptr, nullptr, nullptr) != SQLITE_OK)
+		throw QueryError("Can not unregister table " + name + ": " + last_error());
+}
+
+std::unique_ptr<BlobStream> SQLite3::open_blob(const std::string& table, const std::string& column, const int64_t& rowid, const bool& writable, const size_t& chunk_size, const std::string& db) {
+	sqlite3_blob* blob = nullptr;
+	const Preparer::ErrorLock lock(m_database);
+	if (sqlite3_blob_open(m_database, db.c_str(), table.c_str(), column.c_str(), rowid, writable ? 1 : 0, &blob) != SQLITE_OK) {
+		std::string message = "Can not open blob " + table + "." + column + " for row " + std::to_string(rowid) + ": " + last_error();
+		sqlite3_blob_close(blob); // Handle might be allocated even on failure
+		throw QueryError(std::move(message));
+	}
+	return std::unique_ptr<BlobStream>(new BlobStream(blob, writable, chunk_size));
+}
+
+std::shared_ptr<Profiler> SQLite3::enable_profiling() {
+	if (!m_profiler) {
+		m_profiler = std::make_shared<Profiler>();
+		if (m_database)
+			sqlite3_trace_v2(m_database, SQLITE_TRACE_STMT | SQLITE_TRACE_PROFILE, &Profiler::Callback, m_profiler.get());
+	}
+	return m_profiler;
+}
+
+void SQLite3::disable_profiling() noexcept {
+	if (m_database)
+		sqlite3_trace_v2(m_database, 0, nullptr, nullptr);
+	m_profiler.reset();
+}
+
+std::shared_ptr<Profiler> SQLite3::profiler() const noexcept {
+	return m_profiler;
+}
+
+void SQLite3::start_backup(const std::filesystem::path& file, const int& pages_per_step, const std::chrono::milliseconds& interval, const std::chrono::milliseconds& step_pause) {
+	stop_backup(false);
+	m_backup = std::make_unique<Backup>(m_database, file, pages_per_step, interval, step_pause);
+}
+
+void SQLite3::stop_backup(const bool& final_snapshot) noexcept {
+	if (m_backup) {
+		m_backup->stop(final_snapshot);
+		m_backup.reset();
+	}
+}
+
+bool SQLite3::backup_now() {
+	return m_backup && m_backup->snapshot();
+}
+
+BackupStatistics SQLite3::backup_statistics() const {
+	return m_backup ? m_backup->statistics() : BackupStatistics();
+}
+
+ImportStatistics SQLite3::import_delimited(const std::filesystem::path& file, const std::string& table, const ImportOptions& options) {
+	const auto start = std::chrono::steady_clock::now();
+	ImportStatistics statistics;
+	Importer importer(file, options);
+	statistics.bytes = importer.size();
+	if (importer.columns() == 0)
+		return statistics;
+
+	std::string query = "INSERT INTO " + identifier(table);
+	if (!importer.names().empty()) {
+		query += " (";
+		for (size_t i = 0; i < importer.names().size(); i++)
+			query += (i > 0 ? ", " : "") + identifier(importer.names()[i]);
+		query += ")";
+	}
+	query += " VALUES (?";
+	for (size_t i = 1; i < importer.columns(); i++)
+		query += ", ?";
+	query += ")";
+	// Held for the whole import: the insert statement is shared by every import into the table
+	std::lock_guard<std::recursive_mutex> lock(*m_transaction_mutex);
+	auto it = m_internal_prepared.find(query);
+	if (it == m_internal_prepared.end())
+		it = m_internal_prepared.insert({ query, prepare(query) }).first;
+	const std::shared_ptr<PreparedSTMT> prepared = it->second;
+	PreparedSTMT& insert = *prepared;
+	sqlite3_stmt* stmt = insert.m_stmt;
+	const int columns = static_cast<int>(importer.columns());
+
+	std::optional<Transaction> chunk;
+	size_t chunk_rows = 0;
+	try {
+		while (std::unique_ptr<Importer::Block> block = importer.next()) {
+			const Importer::Field* field = block->fields.data();
+			for (size_t row = 0; row < block->rows; row++) {
+				if (!chunk) {
+					chunk.emplace(transaction(Transaction::Mode::Immediate));
+					chunk_rows = 0;
+				}
+				// Fields point into the mapped file or the block, both outlive the step
+				for (int column = 1; column <= columns; column++, field++) {
+					switch(field->kind) {
+						case Importer::Kind::Null:
+							sqlite3_bind_null(stmt, column);
+							break;
+
+						case Importer::Kind::Integer:
+							sqlite3_bind_int64(stmt, column, field->integer);
+							break;
+
+						default:
+							sqlite3_bind_text64(stmt, column, field->data, field->size, SQLITE_STATIC, SQLITE_UTF8);
+							break;
+					}
+				}
+				const int rc = insert.step();
+				sqlite3_reset(stmt);
+				if (rc != SQLITE_DONE)
+					insert.throw_error(rc);
+				statistics.rows++;
+				if (++chunk_rows == options.rows_per_transaction) {
+					chunk->Commit();
+					chunk.reset();
+					statistics.transactions++;
+				}
+			}
+			if (block->error)
+				std::rethrow_exception(block->error);
+			importer.recycle(std::move(block));
+		}
+		if (chunk) {
+			chunk->Commit();
+			chunk.reset();
+			statistics.transactions++;
+		}
 	}
+	catch (...) {
+		sqlite3_clear_bindings(stmt);
+		throw;
+	}
+	sqlite3_clear_bindings(stmt);
+	statistics.duration = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start);
+	return statistics;
+}
+
+void SQLite3::install_hooks() noexcept {
+	if (!m_database)
+		return;
+
+	m_tracker->install(m_database);
+	m_tracker->attach(m_change_feed, m_query_cache);
+	void* self = m_tracker->active() ? this : nullptr;
+	void* tracker = self ? m_tracker.get() : nullptr;
+	sqlite3_update_hook(m_database, self ? &SQLite3::update_callback : nullptr, self);
+	sqlite3_commit_hook(m_database, tracker ? &CommitTracker::commit_callback : nullptr, tracker);
+	sqlite3_rollback_hook(m_database, tracker ? &CommitTracker::rollback_callback : nullptr, tracker);
+	#ifdef SQLITE_ENABLE_PREUPDATE_HOOK
+	const bool values = m_change_feed && m_change_feed->CapturesValues();
+	sqlite3_preupdate_hook(m_database, values ? &SQLite3::preupdate_callback : nullptr, values ? this : nullptr);
+	#endif
+}
+
+void SQLite3::check_external_changes() {
+	// PRAGMA data_version only moves when other connections commit
+	std::lock_guard<std::recursive_mutex> lock(*m_transaction_mutex);
+	auto it = m_internal_prepared.find("PRAGMA data_version");
+	if (it == m_internal_prepared.end())
+		it = m_internal_prepared.insert({ "PRAGMA data_version", prepare("PRAGMA data_version") }).first;
+
+	sqlite3_stmt* stmt = it->second->m_stmt;
+	if (sqlite3_step(stmt) == SQLITE_ROW) {
+		const int64_t version = sqlite3_column_int64(stmt, 0);
+		if (m_data_version != -1 && version != m_data_version)
+			m_query_cache->Clear();
+		m_data_version = version;
+	}
+	sqlite3_reset(stmt);
+}
+
+void SQLite3::update_callback(void* data, int operation, const char* database, const char* table, long long rowid) {
+	SQLite3* db = static_cast<SQLite3*>(data);
+	if (db->m_query_cache)
+		db->m_query_cache->changed(table);
+
+	#ifdef SQLITE_ENABLE_PREUPDATE_HOOK
+	// Already recorded, with values, by the preupdate hook
+	if (db->m_change_feed && db->m_change_feed->CapturesValues())
+		return;
+	#endif
+	if (db->m_change_feed && db->m_change_feed->watches(table)) {
+		Change change;
+		change.operation = operation == SQLITE_INSERT ? Change::Operation::Insert : operation == SQLITE_DELETE ? Change::Operation::Delete : Change::Operation::Update;
+		change.database = database;
+		change.table = table;
+		change.rowid = change.new_rowid = rowid;
+		db->m_change_feed->record(std::move(change));
+	}
+}
+
+void SQLite3::preupdate_callback([[maybe_unused]] void* data, [[maybe_unused]] sqlite3* handle, [[maybe_unused]] int operation, [[maybe_unused]] const char* database,
+	[[maybe_unused]] const char* table, [[maybe_unused]] long long old_rowid, [[maybe_unused]] long long new_rowid) {
+	#ifdef SQLITE_ENABLE_PREUPDATE_HOOK
+	SQLite3* db = static_cast<SQLite3*>(data);
+	if (!db->m_change_feed || !db->m_change_feed->watches(table))
+		return;
+
+	Change change;
+	change.database = database;
+	change.table = table;
+	switch(operation) {
+		case SQLITE_INSERT:
+			change.operation = Change::Operation::Insert;
+			change.rowid = change.new_rowid = new_rowid;
+			change.new_values = row_values(handle, false);
+			break;
+
+		case SQLITE_DELETE:
+			change.operation = Change::Operation::Delete;
+			change.rowid = change.new_rowid = old_rowid;
+			change.old_values = row_values(handle, true);
+			break;
+
+		default:
+			change.operation = Change::Operation::Update;
+			change.rowid = old_rowid;
+			change.new_rowid = new_rowid;
+			change.old_values = row_values(handle, true);
+			change.new_values = row_values(handle, false);
+			break;
+	}
+	db->m_change_feed->record(std::move(change));
+	#endif
+}
+
+void SQLite3::create_module(const std::string& name, TableSource* source) {
+	const Preparer::ErrorLock lock(m_database);
+	if (TableSource::create_module(m_database, name, source) != SQLITE_OK)
+		throw QueryError("Can not register table " + name + ": " + last_error());
+}
+
+void SQLite3::create_function(const std::string& name, const int& arguments, const bool& deterministic, void* data,
+	void(*scalar)(sqlite3_context*, int, sqlite3_value**), void(*step)(sqlite3_context*, int, sqlite3_value**), void(*finalize)(sqlite3_context*),
+	void(*value)(sqlite3_context*), void(*inverse)(sqlite3_context*, int, sqlite3_value**), void(*destroy)(void*)) {
+	// Deterministic functions can be used in indexes and are factored out of loops by the planner
+	const int flags = SQLITE_UTF8 | (deterministic ? SQLITE_DETERMINISTIC : 0);
+	// On failure SQLite already called destroy on data
+	const Preparer::ErrorLock lock(m_database);
+	int rc;
+	if (value)
+		rc = sqlite3_create_window_function(m_database, name.c_str(), arguments, flags, data, step, finalize, value, inverse, destroy);
+	else
+		rc = sqlite3_create_function_v2(m_database, name.c_str(), arguments, flags, data, scalar, step, finalize, destroy);
+	if (rc != SQLITE_OK)
+		throw QueryError("Can not register function " + name + ": " + last_error());
 }
 
 const std::string SQLite3::last_error() {
@@ -1,48 +1,217 @@
 #pragma once
 
 #ifdef STORMBYTE_ENABLE_SQLITE
-	#include <StormByte/visibility.h>
+	#include <StormByte/database/sqlite/backup.hxx>
+	#include <StormByte/database/sqlite/blob_stream.hxx>
+	#include <StormByte/database/sqlite/busy_handler.hxx>
+	#include <StormByte/database/sqlite/change_feed.hxx>
+	#include <StormByte/database/sqlite/function.hxx>
+	#include <StormByte/database/sqlite/importer.hxx>
+	#include <StormByte/database/sqlite/memory.hxx>
+	#include <StormByte/database/sqlite/profile.hxx>
+	#include <StormByte/database/sqlite/profiler.hxx>
+	#include <StormByte/database/sqlite/query_cache.hxx>
+	#include <StormByte/database/sqlite/statement_status.hxx>
+	#include <StormByte/database/sqlite/transaction.hxx>
+	#include <StormByte/database/sqlite/typed_stmt.hxx>
+	#include <StormByte/database/sqlite/virtual_table.hxx>
 
+	#include <chrono>
+	#include <cstdint>
 	#include <filesystem>
+	#include <functional>
+	#include <future>
 	#include <list>
 	#include <map>
 	#include <memory>
+	#include <mutex>
+	#include <string>
+	#include <vector>
 
 	class sqlite3;
 	namespace StormByte::Database::SQLite {
+		class Checkpointer;
+		class CommitTracker;
+		class GroupCommit;
 		class PreparedSTMT;
+		class Preparer;
 		class Row;
 		class STORMBYTE_PUBLIC SQLite3 {
+			friend class GroupCommit;
+			friend class Transaction;
 			public:
 				SQLite3(const SQLite3& db) 					= delete;
-				SQLite3(SQLite3&& db) noexcept				= default;
+				SQLite3(SQLite3&& db) noexcept;
 				SQLite3& operator=(const SQLite3& db) 		= delete;
-				SQLite3& operator=(SQLite3&& db) noexcept 	= default;
+				SQLite3& operator=(SQLite3&& db) noexcept;
 				virtual ~SQLite3() noexcept;
 
 			protected:
 				SQLite3(const std::filesystem::path& dbfile);
 				SQLite3(std::filesystem::path&& dbfile);
 
-				void 							init_database();
+				// Must run before init_database: WAL writes under synchronous FULL go through io_uring, false if unavailable and the unix VFS stays
+				bool							use_uring_vfs() noexcept;
+				// The profile's pragmas run before post_init_action, which can still override them
+				void 							init_database(const Profile& = Profile::Default);
 				void 							begin_transaction();
 				void 							begin_exclusive_transaction();
 				void 							commit_transaction();
 				void 							rollback_transaction();
+				Transaction						transaction(const Transaction::Mode& = Transaction::Mode::Deferred);
+				// Statements of other threads wait while the committer thread holds its write transaction
+				void							enable_group_commit(const std::chrono::milliseconds&, const size_t& = 64);
+				void							disable_group_commit() noexcept;
+				std::future<void>				group_transaction(std::function<void()>&&);
+				// Needs a WAL database file; automatic checkpoints on commit are turned off while enabled and
+				// the default busy policy is set if none was, as writers wait while the WAL is truncated
+				void							enable_background_checkpoint(const std::chrono::milliseconds& = std::chrono::seconds(1), const size_t& = 64 * 1024 * 1024);
+				void							disable_background_checkpoint() noexcept;
+				void							set_busy_policy(const BusyPolicy&);
+				BusyStatistics					busy_statistics() const noexcept;
+				void							reset_busy_statistics() noexcept;
+				std::shared_ptr<Profiler>		enable_profiling();
+				void							disable_profiling() noexcept;
+				std::shared_ptr<Profiler>		profiler() const noexcept;
 				std::shared_ptr<PreparedSTMT>	prepare_sentence(const std::string&, const std::string&);
-				std::shared_ptr<PreparedSTMT>	get_prepared(const std::string&);
-				void							silent_query(const std::string&);
+				std::shared_ptr<PreparedSTMT>	get_prepared(const std::string&); // Compiles a declared sentence on first use
+				// Only compiled on the first get_prepared, so startup does not pay for sentences that never run
+				void							declare_sentence(const std::string&, const std::string&);
+				// Typed sentences: the descriptor's column count is checked when the statement is compiled, get_prepared
+				// compiles the descriptor's SQL under that name if it was neither prepared nor declared before
+				template<typename P, typename C> TypedSTMT<P, C>	prepare_sentence(const std::string&, const Statement<P, C>&);
+				template<typename P, typename C> TypedSTMT<P, C>	get_prepared(const std::string&, const Statement<P, C>&);
+				template<typename P, typename C> void				declare_sentence(const std::string&, const Statement<P, C>&);
+				// Compiles every declared sentence not asked for yet, on a background thread unless false; that
+				// needs a serialized connection of a thread safe SQLite, without one they stay declared
+				void							prepare_declared(const bool& = true);
+				// By SQL text, for the statements the connection keeps (sentences, internal ones, cached scripts) since it opened or the last reset
+				std::map<std::string, StatementStatus>	statement_status(const bool& = false);
+				ConnectionMemory				memory_status(const bool& = false) const noexcept; // Resets the high water marks
+				// Development aid: runs EXPLAIN QUERY PLAN on every prepare_sentence and flags full table scans
+				void							enable_query_plan_check(Log::Logger* = nullptr, const Log::Level& = Log::Level::Warning);
+				void							disable_query_plan_check() noexcept;
+				const std::map<std::string, std::vector<std::string>>&	query_plan_warnings() const noexcept;
+				// A timeout bounds the whole script, 0 means none
+				void							silent_query(const std::string&, const std::chrono::milliseconds& = std::chrono::milliseconds(0));
+				// Prepares and runs each statement of the script in turn, inside one transaction (a savepoint within one) unless
+				// false, which scripts with their own BEGIN/COMMIT or pragmas refused inside transactions need. Rows are passed
+				// with the statement's position; a cached script keeps its compiled statements for the next run of the same text
+				size_t							execute_script(const std::string&, const std::function<void(const size_t&, const Row&)>& = nullptr, const bool& = true, const bool& = false);
+				// Thread safe: interrupts whatever the connection runs right now
+				void							cancel() noexcept;
+				// Only changes made through this connection invalidate precisely, external ones flush the whole cache
+				std::shared_ptr<QueryCache>		enable_query_cache(const size_t& = 1024, const bool& = true);
+				void							disable_query_cache() noexcept;
+				// Runs (or reuses) the statement with its current bindings, the statement is Reset afterwards
+				std::shared_ptr<const ColumnBatch>	cached_query(const std::string&);
+				std::shared_ptr<const ColumnBatch>	cached_query(PreparedSTMT&);
+				// Committed changes of this connection, row values are only captured when SQLite has preupdate hook support
+				std::shared_ptr<ChangeFeed>		enable_change_feed(const size_t& = 65536, const bool& = true, const std::vector<std::string>& = {});
+				void							disable_change_feed() noexcept;
+				// Background copy of this (usually in memory) database into a file every interval, pages_per_step pages at a time
+				void							start_backup(const std::filesystem::path&, const int& = 256, const std::chrono::milliseconds& = std::chrono::seconds(60), const std::chrono::milliseconds& = std::chrono::milliseconds(5));
+				void							stop_backup(const bool& = true) noexcept;
+				bool							backup_now();
+				BackupStatistics				backup_statistics() const;
+				// Loads a CSV/TSV file into an existing table in chunks of rows_per_transaction rows (savepoints inside a transaction);
+				// when a record is malformed or an insert fails the chunks committed before it stay. Other threads wait until it is done
+				ImportStatistics				import_delimited(const std::filesystem::path&, const std::string&, const ImportOptions& = {});
+				// SQL functions computed by C++ callables, arguments and result are converted from the callable's signature;
+				// only flag them deterministic when the same arguments always give the same result
+				template<typename F> void		register_function(const std::string&, F&&, const bool& = false);
+				// Aggregate (or window, see Function::Window) function backed by a new T for every group
+				template<typename T> void		register_aggregate(const std::string&, const bool& = false);
+				void							unregister_function(const std::string&, const int&);
+				// Read only table (SELECT ... FROM name) over a live range, optionally sorted by one column for index lookups
+				template<typename R> void		register_table(const std::string&, const R&, std::vector<TableColumn<std::ranges::range_value_t<R>>>&&, const int& = -1);
+				void							unregister_table(const std::string&);
+				std::unique_ptr<BlobStream>		open_blob(const std::string&, const std::string&, const int64_t&, const bool& = false, const size_t& = BlobStream::DEFAULT_CHUNK_SIZE, const std::string& = "main");
 				const std::string				last_error();
 
 			private:
 				std::filesystem::path m_database_file;
+				const char* m_vfs; // nullptr for SQLite's default
 				sqlite3* m_database;
 				std::map<std::string, std::shared_ptr<PreparedSTMT>> m_prepared;
+				std::map<std::string, std::shared_ptr<PreparedSTMT>> m_internal_prepared;
+				std::map<std::string, std::string> m_declared; // Name to SQL of sentences not compiled yet
+				std::map<std::string, std::vector<std::shared_ptr<PreparedSTMT>>> m_scripts;
+				std::unique_ptr<Preparer> m_preparer;
+				size_t m_savepoints;
+				size_t m_begin_locks; // Transaction locks taken by begin_transaction and not yet released
+				std::shared_ptr<std::recursive_mutex> m_transaction_mutex; // Transaction state and internal statements, held while a transaction is open
+				std::unique_ptr<GroupCommit> m_group_commit;
+				std::unique_ptr<Checkpointer> m_checkpointer;
+				std::shared_ptr<BusyHandler> m_busy_handler;
+				std::shared_ptr<CommitTracker> m_tracker; // Shared with every statement, which reports to it when done
+				std::shared_ptr<StatementTotals> m_statement_totals;
+				std::shared_ptr<Profiler> m_profiler;
+				std::unique_ptr<Backup> m_backup;
+				bool m_query_plan_check;
+				Log::Logger* m_query_plan_logger;
+				Log::Level m_query_plan_level;
+				std::map<std::string, std::vector<std::string>> m_query_plan_warnings;
+				std::shared_ptr<QueryCache> m_query_cache;
+				bool m_track_external_changes;
+				int64_t m_data_version;
+				std::shared_ptr<ChangeFeed> m_change_feed;
 
 				/* Database internals */
 				virtual void post_init_action() noexcept = 0;
 				void close_database();
 				void enable_foreign_keys();
+				std::shared_ptr<PreparedSTMT> prepare(const std::string&);
+				std::shared_ptr<PreparedSTMT> add_sentence(const std::string&, std::shared_ptr<PreparedSTMT>&&);
+				void execute_internal(const std::string&);
+				void begin_locked(const std::string&);
+				void release_begin_lock() noexcept;
+				// Shares the connection's busy handler, commit tracker and transaction lock with the statement
+				void attach_statement(PreparedSTMT&) const noexcept;
+				void run_script_statement(PreparedSTMT&, const size_t&, const std::function<void(const size_t&, const Row&)>&);
+				void end_transaction(const size_t&, const bool&);
+				void check_query_plan(const std::string&, const std::string&);
+				void install_hooks() noexcept;
+				void check_external_changes();
+				static void update_callback(void*, int, const char*, const char*, long long);
+				static void preupdate_callback(void*, sqlite3*, int, const char*, const char*, long long, long long);
+				void create_module(const std::string&, TableSource*);
+				void create_function(const std::string&, const int&, const bool&, void*,
+					void(*)(sqlite3_context*, int, sqlite3_value**), void(*)(sqlite3_context*, int, sqlite3_value**), void(*)(sqlite3_context*),
+					void(*)(sqlite3_context*), void(*)(sqlite3_context*, int, sqlite3_value**), void(*)(void*));
 		};
+
+		template<typename P, typename C> TypedSTMT<P, C> SQLite3::prepare_sentence(const std::string& name, const Statement<P, C>& statement) {
+			return TypedSTMT<P, C>(prepare_sentence(name, std::string(statement.SQL())));
+		}
+
+		template<typename P, typename C> TypedSTMT<P, C> SQLite3::get_prepared(const std::string& name, const Statement<P, C>& statement) {
+			std::shared_ptr<PreparedSTMT> stmt = get_prepared(name);
+			return TypedSTMT<P, C>(stmt ? std::move(stmt) : prepare_sentence(name, std::string(statement.SQL())));
+		}
+
+		template<typename P, typename C> void SQLite3::declare_sentence(const std::string& name, const Statement<P, C>& statement) {
+			declare_sentence(name, std::string(statement.SQL()));
+		}
+
+		template<typename F> void SQLite3::register_function(const std::string& name, F&& function, const bool& deterministic) {
+			using Callable = std::decay_t<F>;
+			create_function(name, Function::Traits<Callable>::arity, deterministic, new Callable(std::forward<F>(function)),
+				&Function::scalar<Callable>, nullptr, nullptr, nullptr, nullptr, &Function::destroy<Callable>);
+		}
+
+		template<typename R> void SQLite3::register_table(const std::string& name, const R& range, std::vector<TableColumn<std::ranges::range_value_t<R>>>&& columns, const int& sorted_column) {
+			create_module(name, new RangeSource<R>(range, std::move(columns), sorted_column));
+		}
+
+		template<typename T> void SQLite3::register_aggregate(const std::string& name, const bool& deterministic) {
+			constexpr int arity = Function::Traits<decltype(&T::Step)>::arity;
+			if constexpr (Function::Window<T>)
+				create_function(name, arity, deterministic, nullptr,
+					nullptr, &Function::step<T>, &Function::finalize<T>, &Function::value<T>, &Function::inverse<T>, nullptr);
+			else
+				create_function(name, arity, deterministic, nullptr,
+					nullptr, &Function::step<T>, &Function::finalize<T>, nullptr, nullptr, nullptr);
+		}
 	}
  #endif
\ No newline at end of file
@@ -0,0 +1,27 @@
+#include <StormByte/database/sqlite/statement_status.hxx>
+
+#include <utility>
+
+using namespace StormByte::Database::SQLite;
+
+StatementStatus& StatementStatus::operator+=(const StatementStatus& other) noexcept {
+	fullscan_steps	+= other.fullscan_steps;
+	sorts			+= other.sorts;
+	autoindexes		+= other.autoindexes;
+	vm_steps		+= other.vm_steps;
+	reprepares		+= other.reprepares;
+	runs			+= other.runs;
+	return *this;
+}
+
+void StatementTotals::add(const std::string& query, const StatementStatus& status) noexcept {
+	std::lock_guard<std::mutex> lock(m_mutex);
+	m_totals[query] += status;
+}
+
+std::map<std::string, StatementStatus> StatementTotals::totals(const bool& reset) {
+	std::lock_guard<std::mutex> lock(m_mutex);
+	if (reset)
+		return std::exchange(m_totals, {});
+	return m_totals;
+}
@@ -0,0 +1,46 @@
+#pragma once
+
+#ifdef STORMBYTE_ENABLE_SQLITE
+	#include <StormByte/visibility.h>
+
+	#include <cstdint>
+	#include <map>
+	#include <mutex>
+	#include <string>
+
+	namespace StormByte::Database::SQLite {
+		// Virtual machine counters from sqlite3_stmt_status
+		struct STORMBYTE_PUBLIC StatementStatus {
+			uint64_t fullscan_steps		= 0;	// Table/index steps done as part of a full scan
+			uint64_t sorts				= 0;	// Sort operations (an index could have avoided them)
+			uint64_t autoindexes		= 0;	// Rows inserted into automatic indexes (a missing index)
+			uint64_t vm_steps			= 0;	// Virtual machine operations executed
+			uint64_t reprepares			= 0;	// Recompilations after schema changes
+			uint64_t runs				= 0;	// Times the statement ran to completion or was reset
+
+			StatementStatus& operator+=(const StatementStatus&) noexcept;
+		};
+
+		/**
+		 * Counters of a connection's statements by SQL text. SQLite keeps them in 32 bits
+		 * per statement and drops them on finalize, so statements add theirs here and
+		 * zero them before every reset and before they are finalized.
+		 */
+		class STORMBYTE_PRIVATE StatementTotals {
+			public:
+				StatementTotals() noexcept								= default;
+				StatementTotals(const StatementTotals&)					= delete;
+				StatementTotals(StatementTotals&&)						= delete;
+				StatementTotals& operator=(const StatementTotals&)		= delete;
+				StatementTotals& operator=(StatementTotals&&)			= delete;
+				~StatementTotals() noexcept								= default;
+
+				void add(const std::string&, const StatementStatus&) noexcept;
+				std::map<std::string, StatementStatus> totals(const bool&);	// Optionally resets them
+
+			private:
+				std::mutex m_mutex; // Statements finish on any thread, the group committer's included
+				std::map<std::string, StatementStatus> m_totals;
+		};
+	}
+#endif
@@ -0,0 +1,49 @@
+#pragma once
+
+#ifdef STORMBYTE_ENABLE_SQLITE
+	#include <StormByte/database/sqlite/prepared_stmt.hxx>
+
+	#include <functional>
+	#include <string>
+	#include <vector>
+
+	namespace StormByte::Database::SQLite {
+		/**
+		 * Binds the named parameters of a statement from the fields of a T. Names
+		 * are resolved once on construction so binding does no lookups; the binder
+		 * must not outlive the statement.
+		 */
+		template<typename T> class StructBinder {
+			public:
+				struct Field {
+					// Accessor is a data member pointer, a member function pointer or a callable taking const T&
+					template<typename A> Field(std::string name, A accessor):name(std::move(name)),
+					bind([accessor](PreparedSTMT& stmt, const int& index, const T& item) { stmt.bind_value(index, std::invoke(accessor, item)); }) {}
+
+					std::string name;
+					std::function<void(PreparedSTMT&, const int&, const T&)> bind;
+				};
+
+				StructBinder(PreparedSTMT& stmt, std::vector<Field>&& fields):m_stmt(stmt), m_fields(std::move(fields)) {
+					m_indexes.reserve(m_fields.size());
+					for (const auto& field: m_fields)
+						m_indexes.push_back(m_stmt.ParameterIndex(field.name) + 1);
+				}
+				StructBinder(const StructBinder&)				= default;
+				StructBinder(StructBinder&&) noexcept			= default;
+				StructBinder& operator=(const StructBinder&)	= delete;
+				StructBinder& operator=(StructBinder&&)			= delete;
+				~StructBinder() noexcept						= default;
+
+				void Bind(const T& item) const {
+					for (size_t i = 0; i < m_fields.size(); i++)
+						m_fields[i].bind(m_stmt, m_indexes[i], item);
+				}
+
+			private:
+				PreparedSTMT& m_stmt;
+				std::vector<Field> m_fields;
+				std::vector<int> m_indexes;
+		};
+	}
+#endif
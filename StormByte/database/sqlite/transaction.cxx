@@ -0,0 +1,60 @@
+#include <StormByte/database/sqlite/exception.hxx>
+#include <StormByte/database/sqlite/sqlite3.hxx>
+#include <StormByte/database/sqlite/transaction.hxx>
+
+#include <utility>
+
+using namespace StormByte::Database::SQLite;
+
+Transaction::Transaction(SQLite3& db, const size_t& savepoint, std::unique_lock<std::recursive_mutex>&& lock) noexcept:
+m_database(&db), m_savepoint(savepoint), m_lock(std::move(lock)) {}
+
+Transaction::Transaction(Transaction&& other) noexcept:m_database(other.m_database), m_savepoint(other.m_savepoint), m_lock(std::move(other.m_lock)) {
+	other.m_database = nullptr;
+}
+
+Transaction::~Transaction() noexcept {
+	if (m_database) {
+		try {
+			Rollback();
+		}
+		catch (...) {
+			m_database = nullptr;
+		}
+	}
+}
+
+void Transaction::Commit() {
+	if (!m_database)
+		throw Exception("Transaction is no longer active");
+
+	m_database->end_transaction(m_savepoint, true);
+	m_database = nullptr;
+	m_lock.unlock();
+}
+
+void Transaction::Rollback() {
+	if (!m_database)
+		throw Exception("Transaction is no longer active");
+
+	SQLite3* db = m_database;
+	m_database = nullptr;
+	// Released even if the rollback fails, the guard is no longer usable
+	const std::unique_lock<std::recursive_mutex> lock(std::move(m_lock));
+	db->end_transaction(m_savepoint, false);
+}
+
+Transaction Transaction::Savepoint() {
+	if (!m_database)
+		throw Exception("Transaction is no longer active");
+
+	return m_database->transaction();
+}
+
+bool Transaction::IsSavepoint() const noexcept {
+	return m_savepoint > 0;
+}
+
+bool Transaction::IsActive() const noexcept {
+	return m_database != nullptr;
+}
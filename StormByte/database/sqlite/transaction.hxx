@@ -0,0 +1,44 @@
+#pragma once
+
+#ifdef STORMBYTE_ENABLE_SQLITE
+	#include <StormByte/visibility.h>
+
+	#include <cstddef>
+	#include <mutex>
+
+	namespace StormByte::Database::SQLite {
+		class SQLite3;
+		/**
+		 * RAII transaction guard: it starts a transaction if the connection is in
+		 * autocommit mode or a SAVEPOINT when there is already one in progress.
+		 * Guards which are neither committed nor rolled back roll back on destruction.
+		 * Until then they hold the connection's transaction lock, so statements and
+		 * transactions of other threads wait instead of running inside them; they
+		 * must be ended on the thread that started them.
+		 */
+		class STORMBYTE_PUBLIC Transaction {
+			friend class SQLite3;
+			public:
+				enum class Mode: unsigned short { Deferred = 0, Immediate, Exclusive };
+
+				Transaction(const Transaction&)				= delete;
+				Transaction(Transaction&&) noexcept;
+				Transaction& operator=(const Transaction&)	= delete;
+				Transaction& operator=(Transaction&&)		= delete;
+				~Transaction() noexcept;
+
+				void 			Commit();
+				void 			Rollback();
+				Transaction		Savepoint();
+				bool 			IsSavepoint() const noexcept;
+				bool 			IsActive() const noexcept;
+
+			private:
+				Transaction(SQLite3&, const size_t&, std::unique_lock<std::recursive_mutex>&&) noexcept;
+
+				SQLite3* m_database;
+				size_t m_savepoint; // 0 means this is the outermost transaction
+				std::unique_lock<std::recursive_mutex> m_lock;
+		};
+	}
+#endif
@@ -8,7 +8,8 @@
 			Integer = 0,
 			Bool,
 			String,
-			Null
+			Null,
+			Double
 		};
 	}
 #endif
\ No newline at end of file
@@ -0,0 +1,210 @@
+#pragma once
+
+#ifdef STORMBYTE_ENABLE_SQLITE
+	#include <StormByte/database/sqlite/exception.hxx>
+	#include <StormByte/database/sqlite/prepared_stmt.hxx>
+
+	#include <cstdint>
+	#include <memory>
+	#include <optional>
+	#include <string>
+	#include <string_view>
+	#include <tuple>
+	#include <type_traits>
+	#include <utility>
+
+	namespace StormByte::Database::SQLite {
+		template<typename... T> struct Parameters {};
+		template<typename... T> struct Columns {};
+
+		/**
+		 * Supported types are integers, bool, floating point, std::string, std::string_view
+		 * (a column read as one is only valid until the next Step) and std::optional of them
+		 * for NULL; columns that are not optional read NULL as 0 or empty.
+		 */
+		namespace Typed {
+			template<typename T> struct Optional: std::false_type {};
+			template<typename T> struct Optional<std::optional<T>>: std::true_type {};
+			template<typename T> constexpr bool Text = std::is_same_v<T, std::string> || std::is_same_v<T, std::string_view>;
+			template<typename T> constexpr bool Integer = std::is_integral_v<T> && !std::is_same_v<T, bool>;
+
+			template<typename T> struct Supported: std::bool_constant<Integer<T> || std::is_same_v<T, bool> || std::is_floating_point_v<T> || Text<T>> {};
+			template<typename T> struct Supported<std::optional<T>>: Supported<T> {};
+
+			// Whether an argument of type A may be bound to a parameter declared as P
+			template<typename A, typename P> struct Accepts: std::bool_constant<
+				(Integer<P> && Integer<A>) || (std::is_same_v<P, bool> && std::is_same_v<A, bool>)
+				|| (std::is_floating_point_v<P> && std::is_floating_point_v<A>)
+				|| (Text<P> && std::is_convertible_v<const A&, std::string_view>)> {};
+			template<typename A, typename P> struct Accepts<A, std::optional<P>>: std::bool_constant<
+				std::is_same_v<A, std::nullopt_t> || std::is_same_v<A, std::optional<P>> || Accepts<A, P>::value> {};
+
+			// Start and end of the first parameter at or after the position, skipping quotes and comments; (npos, npos) when none is left
+			consteval std::pair<size_t, size_t> next_parameter(const std::string_view& sql, size_t i) {
+				constexpr auto none = std::string_view::npos;
+				const auto name_char = [](const char& c) {
+					return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || (c >= '0' && c <= '9') || c == '_' || static_cast<unsigned char>(c) >= 0x80;
+				};
+				for (; i < sql.size(); i++) {
+					const char c = sql[i];
+					if (c == '\'' || c == '"' || c == '`' || c == '[') {
+						i = sql.find(c == '[' ? ']' : c, i + 1);
+						if (i == none)
+							throw "Unterminated quote in SQL";
+					}
+					else if (sql.substr(i, 2) == "--") {
+						i = sql.find('\n', i);
+						if (i == none)
+							break;
+					}
+					else if (sql.substr(i, 2) == "/*") {
+						i = sql.find("*/", i + 2);
+						if (i == none)
+							break;
+						i++;
+					}
+					else if (c == '?') {
+						size_t end = i + 1;
+						while (end < sql.size() && sql[end] >= '0' && sql[end] <= '9')
+							end++;
+						return { i, end };
+					}
+					else if (c == ':' || c == '@' || c == '$') {
+						size_t end = i + 1;
+						while (end < sql.size() && name_char(sql[end]))
+							end++;
+						if (end > i + 1)
+							return { i, end };
+					}
+				}
+				return { none, none };
+			}
+
+			// Highest parameter number SQLite gives the statement, a name used again keeps the number of its first use
+			consteval size_t parameter_count(const std::string_view& sql) {
+				size_t count = 0;
+				for (auto [start, end] = next_parameter(sql, 0); start != std::string_view::npos; std::tie(start, end) = next_parameter(sql, end)) {
+					const std::string_view parameter = sql.substr(start, end - start);
+					if (parameter == "?")
+						count++;
+					else if (parameter[0] == '?') {
+						size_t number = 0;
+						for (const char& digit: parameter.substr(1))
+							number = number * 10 + static_cast<size_t>(digit - '0');
+						if (number == 0)
+							throw "Parameter ?0 does not exist";
+						if (number > count)
+							count = number;
+					}
+					else {
+						bool seen = false;
+						for (auto [s, e] = next_parameter(sql, 0); s < start && !seen; std::tie(s, e) = next_parameter(sql, e))
+							seen = sql.substr(s, e - s) == parameter;
+						if (!seen)
+							count++;
+					}
+				}
+				return count;
+			}
+		}
+
+		template<typename P, typename C> class TypedSTMT;
+
+		/**
+		 * Statement descriptor meant to be constexpr: the SQL text with the types of its
+		 * parameters and result columns. A parameter count that does not match the SQL
+		 * does not compile; the column count is checked once, when it is prepared.
+		 */
+		template<typename P, typename C> class Statement;
+		template<typename... P, typename... C> class Statement<Parameters<P...>, Columns<C...>> {
+			static_assert((Typed::Supported<P>::value && ...), "Unsupported statement parameter type");
+			static_assert((Typed::Supported<C>::value && ...), "Unsupported statement column type");
+			public:
+				consteval Statement(const char* sql):m_sql(sql) {
+					if (Typed::parameter_count(sql) != sizeof...(P))
+						throw "Statement parameters do not match the SQL";
+				}
+				constexpr Statement(const Statement&) noexcept				= default;
+				constexpr Statement(Statement&&) noexcept					= default;
+				constexpr Statement& operator=(const Statement&) noexcept	= default;
+				constexpr Statement& operator=(Statement&&) noexcept		= default;
+				constexpr ~Statement() noexcept								= default;
+
+				constexpr const char* SQL() const noexcept { return m_sql; }
+
+			private:
+				const char* m_sql;
+		};
+
+		/**
+		 * Prepared statement bound and read through the types of its descriptor:
+		 * arguments and columns are converted by code chosen at compile time, with
+		 * no Result in between and no type checks per value. Shares the statement
+		 * with the connection's PreparedSTMT, which must outlive it.
+		 */
+		template<typename... P, typename... C> class TypedSTMT<Parameters<P...>, Columns<C...>> {
+			public:
+				using Row = std::tuple<C...>;
+
+				TypedSTMT(std::shared_ptr<PreparedSTMT> stmt):m_stmt(std::move(stmt)) {
+					if (m_stmt->parameter_count() != static_cast<int>(sizeof...(P)))
+						throw QueryError("Statement declares " + std::to_string(sizeof...(P)) + " parameters but has " + std::to_string(m_stmt->parameter_count()) + ": " + m_stmt->m_query);
+					if (m_stmt->column_count() != static_cast<int>(sizeof...(C)))
+						throw QueryError("Statement declares " + std::to_string(sizeof...(C)) + " columns but returns " + std::to_string(m_stmt->column_count()) + ": " + m_stmt->m_query);
+				}
+				TypedSTMT(const TypedSTMT&)					= default;
+				TypedSTMT(TypedSTMT&&) noexcept				= default;
+				TypedSTMT& operator=(const TypedSTMT&)		= default;
+				TypedSTMT& operator=(TypedSTMT&&) noexcept	= default;
+				~TypedSTMT() noexcept						= default;
+
+				template<typename... A> requires (sizeof...(A) == sizeof...(P) && (Typed::Accepts<std::remove_cvref_t<A>, P>::value && ...))
+				void 					Bind(const A&... values) noexcept {
+					bind(std::index_sequence_for<A...>(), values...);
+				}
+				// Binds, runs until completion and resets
+				template<typename... A> requires (sizeof...(A) == sizeof...(P) && (Typed::Accepts<std::remove_cvref_t<A>, P>::value && ...))
+				void 					Execute(const A&... values) {
+					Bind(values...);
+					m_stmt->Execute();
+				}
+				std::optional<Row>		Step() {
+					if (!m_stmt->next_row())
+						return std::nullopt;
+					return read(std::index_sequence_for<C...>());
+				}
+				void 					Reset() noexcept { m_stmt->Reset(); }
+				PreparedSTMT&			Untyped() noexcept { return *m_stmt; }
+
+			private:
+				template<size_t... I, typename... A> void bind(std::index_sequence<I...>, const A&... values) noexcept {
+					(bind_one(static_cast<int>(I) + 1, values), ...);
+				}
+				template<typename A> void bind_one(const int& index, const A& value) noexcept {
+					if constexpr (std::is_same_v<A, std::nullopt_t>)
+						m_stmt->bind_null(index);
+					else if constexpr (!Typed::Optional<A>::value && std::is_convertible_v<const A&, std::string_view>)
+						m_stmt->bind_text(index, std::string_view(value));
+					else
+						m_stmt->bind_value(index, value);
+				}
+				template<size_t... I> Row read(std::index_sequence<I...>) const {
+					return Row { column<C>(static_cast<int>(I))... };
+				}
+				template<typename T> T column(const int& index) const {
+					if constexpr (Typed::Optional<T>::value)
+						return m_stmt->column_null(index) ? std::nullopt : T(column<typename T::value_type>(index));
+					else if constexpr (std::is_same_v<T, bool>)
+						return m_stmt->column_integer(index) != 0;
+					else if constexpr (Typed::Integer<T>)
+						return static_cast<T>(m_stmt->column_integer(index));
+					else if constexpr (std::is_floating_point_v<T>)
+						return static_cast<T>(m_stmt->column_double(index));
+					else
+						return T(m_stmt->column_text(index));
+				}
+
+				std::shared_ptr<PreparedSTMT> m_stmt;
+		};
+	}
+#endif
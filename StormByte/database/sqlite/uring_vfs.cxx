@@ -0,0 +1,584 @@
+#include <StormByte/database/sqlite/uring_vfs.hxx>
+
+#include <sqlite3.h>
+
+#ifdef LINUX
+#include <StormByte/system/uring.hxx>
+
+#include <cctype>
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <string>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <vector>
+#endif
+
+using namespace StormByte::Database::SQLite;
+
+#ifdef LINUX
+namespace {
+	struct File;
+
+	// The file holding a thread's buffered writes; other threads take it over under the mutex
+	struct Dirty {
+		std::mutex mutex;
+		File* file = nullptr;
+	};
+
+	struct Extent {
+		sqlite3_int64 offset;
+		size_t start, size; // Bytes in the file's buffer
+	};
+
+	struct File {
+		sqlite3_file base;
+		sqlite3_file* real;
+		int fd = -1;					// Our own descriptor of a WAL, -1 when every call goes to the unix file
+		File* main = nullptr;			// Database the WAL belongs to
+		int synchronous = -1;			// PRAGMA synchronous of a database, -1 while unknown
+		bool synced = false;			// The first sync goes to the unix file, which also syncs the directory of new files
+		int error = SQLITE_OK;			// Failed flush from a call which could not report it
+		std::vector<char> buffer;
+		std::vector<Extent> extents;
+		std::shared_ptr<Dirty> dirty;	// Thread the writes were buffered on
+	};
+
+	// The unix file lives right after ours in the memory SQLite allocates
+	constexpr size_t REAL_OFFSET = (sizeof(File) + 7) & ~size_t(7);
+
+	sqlite3_vfs* unix_vfs = nullptr;
+	sqlite3_vfs uring_vfs;
+	sqlite3_io_methods methods_v1, methods_v3;
+
+	thread_local std::shared_ptr<Dirty> t_dirty = std::make_shared<Dirty>();
+	thread_local std::unique_ptr<StormByte::System::URing> t_ring;
+	thread_local bool t_ring_failed = false;
+
+	File* file_of(sqlite3_file* base) noexcept {
+		return reinterpret_cast<File*>(base);
+	}
+
+	StormByte::System::URing* ring() noexcept {
+		if (!t_ring && !t_ring_failed) {
+			try {
+				t_ring = std::make_unique<StormByte::System::URing>(URingVFS::RING_ENTRIES);
+			}
+			catch (...) {
+				t_ring_failed = true;
+			}
+		}
+		return t_ring.get();
+	}
+
+	bool write_all(const int& fd, const char* data, size_t size, sqlite3_int64 offset) noexcept {
+		while (size > 0) {
+			const ssize_t written = pwrite(fd, data, size, static_cast<off_t>(offset));
+			if (written < 0 && errno == EINTR)
+				continue;
+			if (written <= 0)
+				return false;
+			data += written;
+			size -= static_cast<size_t>(written);
+			offset += written;
+		}
+		return true;
+	}
+
+	// Writes the buffered extents, followed in the same submission by an fsync when sync flags are given
+	int write_out(File* file, const int& sync_flags) noexcept {
+		const bool sync = sync_flags != 0, data_only = (sync_flags & 0x0F) != SQLITE_SYNC_FULL;
+		int rc = SQLITE_OK;
+		StormByte::System::URing* uring = ring();
+		if (uring) {
+			int error = 0;
+			const auto room = [&uring, &error]() {
+				const int failed = uring->Submit();
+				if (failed && !error)
+					error = failed;
+				return !uring->Broken();
+			};
+			bool queued = true;
+			for (const Extent& extent: file->extents) {
+				while (queued && !uring->Write(file->fd, file->buffer.data() + extent.start, extent.size, static_cast<uint64_t>(extent.offset)))
+					queued = room();
+			}
+			while (queued && sync && !uring->Sync(file->fd, data_only))
+				queued = room();
+			if (queued)
+				room();
+
+			if (uring->Broken()) {
+				// Writes are idempotent, the whole batch is redone without the ring
+				t_ring.reset();
+				t_ring_failed = true;
+				uring = nullptr;
+			}
+			else if (error)
+				rc = error == -ENOSPC ? SQLITE_FULL : SQLITE_IOERR_WRITE;
+		}
+		if (!uring) {
+			for (const Extent& extent: file->extents) {
+				if (!write_all(file->fd, file->buffer.data() + extent.start, extent.size, extent.offset))
+					rc = errno == ENOSPC ? SQLITE_FULL : SQLITE_IOERR_WRITE;
+			}
+			if (sync && rc == SQLITE_OK && (data_only ? fdatasync(file->fd) : fsync(file->fd)) != 0)
+				rc = SQLITE_IOERR_FSYNC;
+		}
+		file->buffer.clear();
+		file->extents.clear();
+		return rc;
+	}
+
+	int record(File* file, const int& rc) noexcept {
+		if (rc != SQLITE_OK && file->error == SQLITE_OK)
+			file->error = rc;
+		return rc;
+	}
+
+	int take_error(File* file) noexcept {
+		const int rc = file->error;
+		file->error = SQLITE_OK;
+		return rc;
+	}
+
+	// Writes another thread left buffered for the file go out before it is used here
+	void claim(File* file) noexcept {
+		if (file->dirty && file->dirty != t_dirty) {
+			std::lock_guard<std::mutex> lock(file->dirty->mutex);
+			if (file->dirty->file == file) {
+				record(file, write_out(file, 0));
+				file->dirty->file = nullptr;
+			}
+			file->dirty.reset();
+		}
+	}
+
+	// Ordering point: this thread's buffered writes, to whichever file, reach the kernel
+	void flush_thread(const File* except = nullptr) noexcept {
+		std::lock_guard<std::mutex> lock(t_dirty->mutex);
+		File* file = t_dirty->file;
+		if (file && file != except) {
+			t_dirty->file = nullptr;
+			record(file, write_out(file, 0));
+		}
+	}
+
+	int flush_file(File* file, const int& sync_flags = 0) noexcept {
+		{
+			std::lock_guard<std::mutex> lock(t_dirty->mutex);
+			if (t_dirty->file == file)
+				t_dirty->file = nullptr;
+		}
+		return write_out(file, sync_flags);
+	}
+
+	bool overlaps(const File* file, const sqlite3_int64& offset, const sqlite3_int64& size) noexcept {
+		for (const Extent& extent: file->extents) {
+			if (offset < extent.offset + static_cast<sqlite3_int64>(extent.size) && offset + size > extent.offset)
+				return true;
+		}
+		return false;
+	}
+
+	// Own descriptor for writing the WAL the unix VFS just opened, -1 (writes are not buffered) when it can not be had.
+	// Only WAL files get one: closing a descriptor drops every POSIX lock of the process on the file, which for
+	// the database would release the locks of other connections, and the WAL is never locked that way
+	int descriptor(const char* name) noexcept {
+		struct stat by_name, by_fd;
+		if (!name || stat(name, &by_name) != 0 || !S_ISREG(by_name.st_mode))
+			return -1;
+		int fd;
+		while ((fd = open(name, O_RDWR | O_CLOEXEC)) < 0 && errno == EINTR);
+		if (fd < 0)
+			return -1;
+		// Renamed or replaced in between, never write to another file than SQLite's
+		if (fstat(fd, &by_fd) != 0 || by_fd.st_dev != by_name.st_dev || by_fd.st_ino != by_name.st_ino) {
+			close(fd);
+			return -1;
+		}
+		return fd;
+	}
+
+	int synchronous_level(std::string value) noexcept {
+		for (char& c: value)
+			c = static_cast<char>(std::tolower(static_cast<unsigned char>(c)));
+		if (value == "0" || value == "off" || value == "no" || value == "false")
+			return 0;
+		if (value == "1" || value == "normal" || value == "on" || value == "yes" || value == "true")
+			return 1;
+		if (value == "2" || value == "full")
+			return 2;
+		if (value == "3" || value == "extra")
+			return 3;
+		return -1;
+	}
+
+	// Writes may only wait for an ordering point when an xSync of the file, which can report their failure,
+	// is sure to follow: with synchronous FULL or EXTRA every WAL commit syncs its frames, under NORMAL
+	// it never does and a failed write could only be dropped
+	bool deferred(const File* file) noexcept {
+		return file->fd >= 0 && file->main->synchronous >= 2;
+	}
+
+	int x_close(sqlite3_file* base) {
+		File* file = file_of(base);
+		claim(file);
+		flush_thread();
+		const int error = take_error(file);
+		const int rc = file->real->pMethods->xClose(file->real);
+		if (file->fd >= 0)
+			close(file->fd);
+		file->~File();
+		return rc != SQLITE_OK ? rc : error;
+	}
+
+	int x_read(sqlite3_file* base, void* data, int amount, sqlite3_int64 offset) {
+		File* file = file_of(base);
+		if (file->fd >= 0) {
+			claim(file);
+			if (overlaps(file, offset, amount)) {
+				if (const int rc = flush_file(file))
+					return rc;
+			}
+		}
+		return file->real->pMethods->xRead(file->real, data, amount, offset);
+	}
+
+	int x_write(sqlite3_file* base, const void* data, int amount, sqlite3_int64 offset) {
+		File* file = file_of(base);
+		if (!deferred(file)) {
+			claim(file);
+			flush_thread();
+			if (const int rc = take_error(file))
+				return rc;
+			if (!file->extents.empty()) {
+				if (const int rc = flush_file(file))
+					return rc;
+			}
+			return file->real->pMethods->xWrite(file->real, data, amount, offset);
+		}
+
+		claim(file);
+		// Writes to other files were issued first and keep their order
+		flush_thread(file);
+		if (const int rc = take_error(file))
+			return rc;
+
+		const size_t size = static_cast<size_t>(amount);
+		const char* bytes = static_cast<const char*>(data);
+		try {
+			for (const Extent& extent: file->extents) {
+				const sqlite3_int64 end = extent.offset + static_cast<sqlite3_int64>(extent.size);
+				if (offset < end && offset + amount > extent.offset) {
+					// Rewrite of buffered bytes, like a WAL frame updated again in the same transaction
+					if (offset >= extent.offset && offset + amount <= end) {
+						std::memcpy(file->buffer.data() + extent.start + static_cast<size_t>(offset - extent.offset), bytes, size);
+						return SQLITE_OK;
+					}
+					if (const int rc = flush_file(file))
+						return rc;
+					break;
+				}
+			}
+			if (!file->buffer.empty() && file->buffer.size() + size > URingVFS::BUFFER_SIZE) {
+				if (const int rc = flush_file(file))
+					return rc;
+			}
+			if (size > URingVFS::BUFFER_SIZE)
+				return write_all(file->fd, bytes, size, offset) ? SQLITE_OK : errno == ENOSPC ? SQLITE_FULL : SQLITE_IOERR_WRITE;
+
+			if (file->buffer.capacity() < URingVFS::BUFFER_SIZE)
+				file->buffer.reserve(URingVFS::BUFFER_SIZE);
+			const size_t start = file->buffer.size();
+			file->buffer.insert(file->buffer.end(), bytes, bytes + size);
+			if (!file->extents.empty() && file->extents.back().offset + static_cast<sqlite3_int64>(file->extents.back().size) == offset)
+				file->extents.back().size += size;
+			else
+				file->extents.push_back({ offset, start, size });
+		}
+		catch (const std::bad_alloc&) {
+			if (const int rc = flush_file(file))
+				return rc;
+			return write_all(file->fd, bytes, size, offset) ? SQLITE_OK : SQLITE_IOERR_WRITE;
+		}
+
+		{
+			std::lock_guard<std::mutex> lock(t_dirty->mutex);
+			t_dirty->file = file;
+		}
+		file->dirty = t_dirty;
+		return SQLITE_OK;
+	}
+
+	int x_truncate(sqlite3_file* base, sqlite3_int64 size) {
+		File* file = file_of(base);
+		if (file->fd >= 0) {
+			claim(file);
+			flush_thread();
+			if (const int rc = take_error(file))
+				return rc;
+		}
+		return file->real->pMethods->xTruncate(file->real, size);
+	}
+
+	int x_sync(sqlite3_file* base, int flags) {
+		File* file = file_of(base);
+		if (file->fd < 0) {
+			flush_thread();
+			return file->real->pMethods->xSync(file->real, flags);
+		}
+
+		claim(file);
+		flush_thread(file);
+		if (const int rc = take_error(file))
+			return rc;
+		if (!file->synced) {
+			file->synced = true;
+			if (const int rc = flush_file(file))
+				return rc;
+			return file->real->pMethods->xSync(file->real, flags);
+		}
+		// The buffered writes and the fsync after them in one submission
+		return flush_file(file, flags);
+	}
+
+	int x_file_size(sqlite3_file* base, sqlite3_int64* size) {
+		File* file = file_of(base);
+		if (file->fd >= 0) {
+			claim(file);
+			if (!file->extents.empty()) {
+				if (const int rc = flush_file(file))
+					return rc;
+			}
+		}
+		return file->real->pMethods->xFileSize(file->real, size);
+	}
+
+	// Lock changes and file controls are ordering points for every file written on this thread
+	int x_lock(sqlite3_file* base, int level) {
+		File* file = file_of(base);
+		claim(file);
+		flush_thread();
+		return file->real->pMethods->xLock(file->real, level);
+	}
+
+	int x_unlock(sqlite3_file* base, int level) {
+		File* file = file_of(base);
+		claim(file);
+		flush_thread();
+		return file->real->pMethods->xUnlock(file->real, level);
+	}
+
+	int x_check_reserved_lock(sqlite3_file* base, int* result) {
+		File* file = file_of(base);
+		return file->real->pMethods->xCheckReservedLock(file->real, result);
+	}
+
+	int x_file_control(sqlite3_file* base, int op, void* arg) {
+		File* file = file_of(base);
+		claim(file);
+		flush_thread();
+		// Every pragma is offered to the VFS first, on the database file; SQLite still runs it
+		if (op == SQLITE_FCNTL_PRAGMA) {
+			char** pragma = static_cast<char**>(arg);
+			if (pragma[1] && pragma[2] && sqlite3_stricmp(pragma[1], "synchronous") == 0)
+				file->synchronous = synchronous_level(pragma[2]);
+		}
+		return file->real->pMethods->xFileControl(file->real, op, arg);
+	}
+
+	int x_sector_size(sqlite3_file* base) {
+		File* file = file_of(base);
+		return file->real->pMethods->xSectorSize(file->real);
+	}
+
+	int x_device_characteristics(sqlite3_file* base) {
+		File* file = file_of(base);
+		return file->real->pMethods->xDeviceCharacteristics(file->real);
+	}
+
+	int x_shm_map(sqlite3_file* base, int region, int size, int extend, void volatile** memory) {
+		File* file = file_of(base);
+		return file->real->pMethods->xShmMap(file->real, region, size, extend, memory);
+	}
+
+	int x_shm_lock(sqlite3_file* base, int offset, int count, int flags) {
+		File* file = file_of(base);
+		claim(file);
+		flush_thread();
+		return file->real->pMethods->xShmLock(file->real, offset, count, flags);
+	}
+
+	// WAL frames must be in the file before the index header publishing them is
+	void x_shm_barrier(sqlite3_file* base) {
+		File* file = file_of(base);
+		claim(file);
+		flush_thread();
+		file->real->pMethods->xShmBarrier(file->real);
+	}
+
+	int x_shm_unmap(sqlite3_file* base, int remove) {
+		File* file = file_of(base);
+		claim(file);
+		flush_thread();
+		return file->real->pMethods->xShmUnmap(file->real, remove);
+	}
+
+	int x_fetch(sqlite3_file* base, sqlite3_int64 offset, int amount, void** pointer) {
+		File* file = file_of(base);
+		if (file->fd >= 0) {
+			claim(file);
+			if (overlaps(file, offset, amount)) {
+				if (const int rc = flush_file(file))
+					return rc;
+			}
+		}
+		return file->real->pMethods->xFetch(file->real, offset, amount, pointer);
+	}
+
+	int x_unfetch(sqlite3_file* base, sqlite3_int64 offset, void* pointer) {
+		File* file = file_of(base);
+		return file->real->pMethods->xUnfetch(file->real, offset, pointer);
+	}
+
+	int x_open(sqlite3_vfs*, sqlite3_filename name, sqlite3_file* base, int flags, int* out_flags) {
+		File* file = new (base) File();
+		file->real = reinterpret_cast<sqlite3_file*>(reinterpret_cast<char*>(base) + REAL_OFFSET);
+		const int rc = unix_vfs->xOpen(unix_vfs, name, file->real, flags, out_flags);
+		if (rc != SQLITE_OK || !file->real->pMethods) {
+			if (file->real->pMethods)
+				file->real->pMethods->xClose(file->real);
+			file->~File();
+			base->pMethods = nullptr;
+			return rc != SQLITE_OK ? rc : SQLITE_CANTOPEN;
+		}
+		if ((flags & SQLITE_OPEN_READWRITE) && (flags & SQLITE_OPEN_WAL)) {
+			File* main = file_of(sqlite3_database_file_object(name));
+			if (main->base.pMethods == &methods_v1 || main->base.pMethods == &methods_v3) {
+				file->main = main;
+				file->fd = descriptor(name);
+			}
+		}
+		base->pMethods = file->real->pMethods->iVersion >= 3 ? &methods_v3 : &methods_v1;
+		return SQLITE_OK;
+	}
+
+	// Deleting a journal commits the transaction, every write before it has to be issued
+	int x_delete(sqlite3_vfs*, const char* name, int sync_dir) {
+		flush_thread();
+		return unix_vfs->xDelete(unix_vfs, name, sync_dir);
+	}
+
+	int x_access(sqlite3_vfs*, const char* name, int flags, int* result) {
+		return unix_vfs->xAccess(unix_vfs, name, flags, result);
+	}
+
+	int x_full_pathname(sqlite3_vfs*, const char* name, int size, char* out) {
+		return unix_vfs->xFullPathname(unix_vfs, name, size, out);
+	}
+
+	void* x_dl_open(sqlite3_vfs*, const char* name) {
+		return unix_vfs->xDlOpen(unix_vfs, name);
+	}
+
+	void x_dl_error(sqlite3_vfs*, int size, char* out) {
+		unix_vfs->xDlError(unix_vfs, size, out);
+	}
+
+	using Symbol = void(*)(void);
+	Symbol x_dl_sym(sqlite3_vfs*, void* handle, const char* symbol) {
+		return unix_vfs->xDlSym(unix_vfs, handle, symbol);
+	}
+
+	void x_dl_close(sqlite3_vfs*, void* handle) {
+		unix_vfs->xDlClose(unix_vfs, handle);
+	}
+
+	int x_randomness(sqlite3_vfs*, int size, char* out) {
+		return unix_vfs->xRandomness(unix_vfs, size, out);
+	}
+
+	int x_sleep(sqlite3_vfs*, int microseconds) {
+		return unix_vfs->xSleep(unix_vfs, microseconds);
+	}
+
+	int x_current_time(sqlite3_vfs*, double* now) {
+		return unix_vfs->xCurrentTime(unix_vfs, now);
+	}
+
+	int x_get_last_error(sqlite3_vfs*, int size, char* out) {
+		return unix_vfs->xGetLastError ? unix_vfs->xGetLastError(unix_vfs, size, out) : 0;
+	}
+
+	int x_current_time_int64(sqlite3_vfs*, sqlite3_int64* now) {
+		return unix_vfs->xCurrentTimeInt64(unix_vfs, now);
+	}
+
+	void fill_methods(sqlite3_io_methods& methods, const int& version) noexcept {
+		std::memset(&methods, 0, sizeof(methods));
+		methods.iVersion = version;
+		methods.xClose = x_close;
+		methods.xRead = x_read;
+		methods.xWrite = x_write;
+		methods.xTruncate = x_truncate;
+		methods.xSync = x_sync;
+		methods.xFileSize = x_file_size;
+		methods.xLock = x_lock;
+		methods.xUnlock = x_unlock;
+		methods.xCheckReservedLock = x_check_reserved_lock;
+		methods.xFileControl = x_file_control;
+		methods.xSectorSize = x_sector_size;
+		methods.xDeviceCharacteristics = x_device_characteristics;
+		if (version >= 3) {
+			methods.xShmMap = x_shm_map;
+			methods.xShmLock = x_shm_lock;
+			methods.xShmBarrier = x_shm_barrier;
+			methods.xShmUnmap = x_shm_unmap;
+			methods.xFetch = x_fetch;
+			methods.xUnfetch = x_unfetch;
+		}
+	}
+}
+#endif
+
+bool URingVFS::Register() noexcept {
+	#ifdef LINUX
+	static const bool registered = [] {
+		unix_vfs = sqlite3_vfs_find("unix");
+		if (!unix_vfs || unix_vfs->iVersion < 2 || !System::URing::Available())
+			return false;
+
+		fill_methods(methods_v1, 1);
+		fill_methods(methods_v3, 3);
+		std::memset(&uring_vfs, 0, sizeof(uring_vfs));
+		uring_vfs.iVersion = 2;
+		uring_vfs.szOsFile = static_cast<int>(REAL_OFFSET) + unix_vfs->szOsFile;
+		uring_vfs.mxPathname = unix_vfs->mxPathname;
+		uring_vfs.zName = NAME;
+		uring_vfs.xOpen = x_open;
+		uring_vfs.xDelete = x_delete;
+		uring_vfs.xAccess = x_access;
+		uring_vfs.xFullPathname = x_full_pathname;
+		if (unix_vfs->xDlOpen) {
+			uring_vfs.xDlOpen = x_dl_open;
+			uring_vfs.xDlError = x_dl_error;
+			uring_vfs.xDlSym = x_dl_sym;
+			uring_vfs.xDlClose = x_dl_close;
+		}
+		uring_vfs.xRandomness = x_randomness;
+		uring_vfs.xSleep = x_sleep;
+		uring_vfs.xCurrentTime = x_current_time;
+		uring_vfs.xGetLastError = x_get_last_error;
+		uring_vfs.xCurrentTimeInt64 = x_current_time_int64;
+		return sqlite3_vfs_register(&uring_vfs, 0) == SQLITE_OK;
+	}();
+	return registered;
+	#else
+	return false;
+	#endif
+}
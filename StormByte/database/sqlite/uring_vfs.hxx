@@ -0,0 +1,31 @@
+#pragma once
+
+#ifdef STORMBYTE_ENABLE_SQLITE
+	#include <StormByte/visibility.h>
+
+	#include <cstddef>
+
+	namespace StormByte::Database::SQLite {
+		/**
+		 * VFS layered over the unix one, which keeps everything but WAL writes and
+		 * syncs. Under PRAGMA synchronous FULL or EXTRA, where every commit syncs
+		 * the WAL, contiguous frame writes are coalesced and reach the kernel at
+		 * the next ordering point (a sync, lock change, shared memory barrier,
+		 * delete or a write to another file on the same thread); at the commit's
+		 * sync the whole batch and the fsync after it are submitted with a single
+		 * system call. Otherwise writes go straight through, as nothing would be
+		 * left to report their failure. Only transactions writing many pages gain.
+		 */
+		class STORMBYTE_PRIVATE URingVFS {
+			public:
+				static constexpr const char* NAME			= "stormbyte-uring";
+				static constexpr size_t BUFFER_SIZE			= 1024 * 1024; // Coalesced bytes per file before a flush
+				static constexpr unsigned int RING_ENTRIES	= 64;
+
+				URingVFS()									= delete;
+
+				// Registers the VFS once per process, false when io_uring can not be used and the unix VFS stays
+				static bool Register() noexcept;
+		};
+	}
+#endif
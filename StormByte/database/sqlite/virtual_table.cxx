@@ -0,0 +1,242 @@
+#include <StormByte/database/sqlite/virtual_table.hxx>
+
+#include <cmath>
+#include <new>
+#include <sqlite3.h>
+
+using namespace StormByte::Database::SQLite;
+
+namespace {
+	// idxNum flags telling xFilter which constraints on the sorted column were passed, in this order
+	constexpr int FILTER_EQ = 1, FILTER_GE = 2, FILTER_GT = 4, FILTER_LE = 8, FILTER_LT = 16;
+
+	struct Table {
+		sqlite3_vtab base;
+		TableSource* source;
+	};
+
+	struct Cursor {
+		sqlite3_vtab_cursor base;
+		size_t row, end;
+	};
+
+	TableSource* source_of(sqlite3_vtab_cursor* cursor) {
+		return reinterpret_cast<Table*>(cursor->pVtab)->source;
+	}
+
+	int connect(sqlite3* db, void* aux, int, const char* const*, sqlite3_vtab** vtab, char**) {
+		TableSource* source = static_cast<TableSource*>(aux);
+		int rc = sqlite3_declare_vtab(db, source->Declaration().c_str());
+		if (rc != SQLITE_OK)
+			return rc;
+
+		Table* table = new (std::nothrow) Table();
+		if (!table)
+			return SQLITE_NOMEM;
+		table->source = source;
+		*vtab = &table->base;
+		return SQLITE_OK;
+	}
+
+	int disconnect(sqlite3_vtab* vtab) {
+		delete reinterpret_cast<Table*>(vtab);
+		return SQLITE_OK;
+	}
+
+	int best_index(sqlite3_vtab* vtab, sqlite3_index_info* info) {
+		const TableSource* source = reinterpret_cast<Table*>(vtab)->source;
+		const int sorted = source->SortedColumn();
+		const bool text = source->SortedText();
+		const double rows = static_cast<double>(source->Size());
+		int eq = -1, lower = -1, upper = -1, flags = 0;
+
+		for (int i = 0; sorted >= 0 && i < info->nConstraint; i++) {
+			const auto& constraint = info->aConstraint[i];
+			if (!constraint.usable || constraint.iColumn != sorted)
+				continue;
+			// A NOCASE or RTRIM comparison matches rows the binary search would skip
+			const char* collation = text ? sqlite3_vtab_collation(info, i) : nullptr;
+			if (collation && sqlite3_stricmp(collation, "BINARY") != 0)
+				continue;
+			switch(constraint.op) {
+				case SQLITE_INDEX_CONSTRAINT_EQ:
+					eq = i;
+					break;
+
+				case SQLITE_INDEX_CONSTRAINT_GE:
+				case SQLITE_INDEX_CONSTRAINT_GT:
+					lower = i;
+					break;
+
+				case SQLITE_INDEX_CONSTRAINT_LE:
+				case SQLITE_INDEX_CONSTRAINT_LT:
+					upper = i;
+					break;
+
+				default:
+					break;
+			}
+		}
+
+		// SQLite double checks the constraints (omit stays 0), so narrowing only needs to be a superset
+		int argument = 1;
+		if (eq >= 0) {
+			info->aConstraintUsage[eq].argvIndex = argument++;
+			flags |= FILTER_EQ;
+		}
+		else {
+			if (lower >= 0) {
+				info->aConstraintUsage[lower].argvIndex = argument++;
+				flags |= info->aConstraint[lower].op == SQLITE_INDEX_CONSTRAINT_GT ? FILTER_GT : FILTER_GE;
+			}
+			if (upper >= 0) {
+				info->aConstraintUsage[upper].argvIndex = argument++;
+				flags |= info->aConstraint[upper].op == SQLITE_INDEX_CONSTRAINT_LT ? FILTER_LT : FILTER_LE;
+			}
+		}
+		info->idxNum = flags;
+
+		const double search = std::log2(rows + 1) + 1;
+		if (flags & FILTER_EQ) {
+			info->estimatedCost = search;
+			info->estimatedRows = 1;
+		}
+		else if (flags) {
+			const double estimate = (lower >= 0 && upper >= 0) ? rows / 16 : rows / 4;
+			info->estimatedCost = search + estimate;
+			info->estimatedRows = static_cast<sqlite3_int64>(estimate) + 1;
+		}
+		else {
+			info->estimatedCost = rows + 1;
+			info->estimatedRows = static_cast<sqlite3_int64>(rows);
+		}
+
+		if (sorted >= 0 && info->nOrderBy == 1 && info->aOrderBy[0].iColumn == sorted && !info->aOrderBy[0].desc)
+			info->orderByConsumed = 1;
+		return SQLITE_OK;
+	}
+
+	int open(sqlite3_vtab*, sqlite3_vtab_cursor** cursor) {
+		Cursor* c = new (std::nothrow) Cursor();
+		if (!c)
+			return SQLITE_NOMEM;
+		*cursor = &c->base;
+		return SQLITE_OK;
+	}
+
+	int close(sqlite3_vtab_cursor* cursor) {
+		delete reinterpret_cast<Cursor*>(cursor);
+		return SQLITE_OK;
+	}
+
+	int filter(sqlite3_vtab_cursor* cursor, int flags, const char*, int, sqlite3_value** argv) {
+		Cursor* c = reinterpret_cast<Cursor*>(cursor);
+		const TableSource* source = source_of(cursor);
+		size_t begin = 0, end = source->Size();
+		int argument = 0;
+
+		try {
+			if (flags & FILTER_EQ) {
+				sqlite3_value* value = argv[argument++];
+				if (source->Comparable(value)) {
+					begin = source->LowerBound(value, begin, end);
+					end = source->UpperBound(value, begin, end);
+				}
+			}
+			if (flags & (FILTER_GE | FILTER_GT)) {
+				sqlite3_value* value = argv[argument++];
+				if (source->Comparable(value))
+					begin = (flags & FILTER_GT) ? source->UpperBound(value, begin, end) : source->LowerBound(value, begin, end);
+			}
+			if (flags & (FILTER_LE | FILTER_LT)) {
+				sqlite3_value* value = argv[argument++];
+				if (source->Comparable(value))
+					end = (flags & FILTER_LT) ? source->LowerBound(value, begin, end) : source->UpperBound(value, begin, end);
+			}
+		}
+		catch (const std::exception& e) {
+			sqlite3_free(cursor->pVtab->zErrMsg);
+			cursor->pVtab->zErrMsg = sqlite3_mprintf("%s", e.what());
+			return SQLITE_ERROR;
+		}
+
+		c->row = begin;
+		c->end = end < begin ? begin : end;
+		return SQLITE_OK;
+	}
+
+	int next(sqlite3_vtab_cursor* cursor) {
+		reinterpret_cast<Cursor*>(cursor)->row++;
+		return SQLITE_OK;
+	}
+
+	int eof(sqlite3_vtab_cursor* cursor) {
+		const Cursor* c = reinterpret_cast<Cursor*>(cursor);
+		return c->row >= c->end;
+	}
+
+	int column(sqlite3_vtab_cursor* cursor, sqlite3_context* ctx, int index) {
+		const size_t row = reinterpret_cast<Cursor*>(cursor)->row;
+		const TableSource* source = source_of(cursor);
+		// Rows removed from the range since the scan started read as NULL
+		if (row < source->Size())
+			source->Value(ctx, row, index);
+		else
+			sqlite3_result_null(ctx);
+		return SQLITE_OK;
+	}
+
+	int rowid(sqlite3_vtab_cursor* cursor, sqlite3_int64* id) {
+		*id = static_cast<sqlite3_int64>(reinterpret_cast<Cursor*>(cursor)->row);
+		return SQLITE_OK;
+	}
+
+	void destroy_source(void* source) {
+		delete static_cast<TableSource*>(source);
+	}
+
+	sqlite3_module make_module() {
+		// Eponymous only (no xCreate/xDestroy): the table exists under the module name without CREATE VIRTUAL TABLE
+		sqlite3_module module {};
+		module.xConnect		= connect;
+		module.xBestIndex	= best_index;
+		module.xDisconnect	= disconnect;
+		module.xOpen		= open;
+		module.xClose		= close;
+		module.xFilter		= filter;
+		module.xNext		= next;
+		module.xEof			= eof;
+		module.xColumn		= column;
+		module.xRowid		= rowid;
+		return module;
+	}
+
+	const sqlite3_module range_module = make_module();
+}
+
+size_t TableSource::LowerBound(sqlite3_value* value, size_t begin, size_t end) const {
+	while (begin < end) {
+		const size_t middle = begin + (end - begin) / 2;
+		if (Compare(middle, value) < 0)
+			begin = middle + 1;
+		else
+			end = middle;
+	}
+	return begin;
+}
+
+size_t TableSource::UpperBound(sqlite3_value* value, size_t begin, size_t end) const {
+	while (begin < end) {
+		const size_t middle = begin + (end - begin) / 2;
+		if (Compare(middle, value) <= 0)
+			begin = middle + 1;
+		else
+			end = middle;
+	}
+	return begin;
+}
+
+int TableSource::create_module(sqlite3* db, const std::string& name, TableSource* source) {
+	// SQLite calls destroy_source on failure too
+	return sqlite3_create_module_v2(db, name.c_str(), &range_module, source, &destroy_source);
+}
@@ -0,0 +1,165 @@
+#pragma once
+
+#ifdef STORMBYTE_ENABLE_SQLITE
+	#include <StormByte/database/sqlite/function.hxx>
+
+	#include <compare>
+	#include <functional>
+	#include <ranges>
+	#include <string>
+	#include <vector>
+
+	class sqlite3;
+	namespace StormByte::Database::SQLite {
+		/**
+		 * Read only rows exposed to SQL as an eponymous virtual table, see
+		 * SQLite3::register_table. Rows are addressed by position; when a sorted
+		 * column is set, rows must be ordered by it so equality and range
+		 * constraints on it are answered with a binary search.
+		 */
+		class STORMBYTE_PUBLIC TableSource {
+			friend class SQLite3;
+			public:
+				TableSource()										= default;
+				TableSource(const TableSource&)						= delete;
+				TableSource(TableSource&&)							= delete;
+				TableSource& operator=(const TableSource&)			= delete;
+				TableSource& operator=(TableSource&&)				= delete;
+				virtual ~TableSource() noexcept						= default;
+
+				virtual std::string 			Declaration() const = 0; // CREATE TABLE statement for sqlite3_declare_vtab
+				virtual size_t 					Size() const = 0;
+				virtual void 					Value(sqlite3_context*, const size_t&, const int&) const = 0;
+				virtual int 					SortedColumn() const noexcept = 0; // -1 if none
+				// Text is only in sorted order under the BINARY collation, constraints with another one are not narrowed
+				virtual bool 					SortedText() const noexcept = 0;
+				// Whether the value can be compared with the sorted column, if not rows are not narrowed
+				virtual bool 					Comparable(sqlite3_value*) const = 0;
+				virtual std::weak_ordering		Compare(const size_t&, sqlite3_value*) const = 0;
+
+				size_t 							LowerBound(sqlite3_value*, size_t, size_t) const; // First row not less than value
+				size_t 							UpperBound(sqlite3_value*, size_t, size_t) const; // First row greater than value
+
+			private:
+				// Takes ownership of the source, which is deleted when the module is dropped
+				static int create_module(sqlite3*, const std::string&, TableSource*);
+		};
+
+		template<typename T> class TableColumn {
+			public:
+				// Accessor is a data member pointer, a member function pointer or a callable taking const T&
+				template<typename A> TableColumn(std::string name, A accessor);
+
+				const std::string& 				Name() const noexcept { return m_name; }
+				const std::string& 				SQLType() const noexcept { return m_type; }
+				void 							Value(sqlite3_context* ctx, const T& item) const { m_value(ctx, item); }
+				bool 							Comparable(sqlite3_value* value) const { return m_comparable(value); }
+				std::weak_ordering 				Compare(const T& item, sqlite3_value* value) const { return m_compare(item, value); }
+
+			private:
+				std::string m_name, m_type;
+				std::function<void(sqlite3_context*, const T&)> m_value;
+				std::function<bool(sqlite3_value*)> m_comparable;
+				std::function<std::weak_ordering(const T&, sqlite3_value*)> m_compare;
+		};
+
+		template<typename R> requires std::ranges::random_access_range<const R> && std::ranges::sized_range<const R>
+		class RangeSource final: public TableSource {
+			public:
+				using Item = std::ranges::range_value_t<R>;
+
+				// The range is referenced, not copied: it must outlive the registration and not change while a query reads it
+				RangeSource(const R& range, std::vector<TableColumn<Item>>&& columns, const int& sorted_column):
+				m_range(&range), m_columns(std::move(columns)), m_sorted_column(sorted_column < static_cast<int>(m_columns.size()) ? sorted_column : -1) {}
+
+				std::string Declaration() const override {
+					std::string declaration = "CREATE TABLE x(";
+					for (size_t i = 0; i < m_columns.size(); i++) {
+						if (i > 0)
+							declaration += ", ";
+						declaration += "\"" + m_columns[i].Name() + "\" " + m_columns[i].SQLType();
+					}
+					return declaration + ")";
+				}
+
+				size_t Size() const override {
+					return static_cast<size_t>(std::ranges::size(*m_range));
+				}
+
+				void Value(sqlite3_context* ctx, const size_t& row, const int& column) const override {
+					try {
+						m_columns[static_cast<size_t>(column)].Value(ctx, item(row));
+					}
+					catch (const std::bad_alloc&) {
+						Function::set_nomem(ctx);
+					}
+					catch (const std::exception& e) {
+						Function::set_error(ctx, e.what());
+					}
+					catch (...) {
+						Function::set_error(ctx, "Unknown exception reading a virtual table column");
+					}
+				}
+
+				int SortedColumn() const noexcept override {
+					return m_sorted_column;
+				}
+
+				bool SortedText() const noexcept override {
+					return m_sorted_column >= 0 && m_columns[static_cast<size_t>(m_sorted_column)].SQLType() == "TEXT";
+				}
+
+				bool Comparable(sqlite3_value* value) const override {
+					return m_sorted_column >= 0 && m_columns[static_cast<size_t>(m_sorted_column)].Comparable(value);
+				}
+
+				std::weak_ordering Compare(const size_t& row, sqlite3_value* value) const override {
+					return m_columns[static_cast<size_t>(m_sorted_column)].Compare(item(row), value);
+				}
+
+			private:
+				const R* m_range;
+				std::vector<TableColumn<Item>> m_columns;
+				int m_sorted_column;
+
+				const Item& item(const size_t& row) const {
+					return std::ranges::begin(*m_range)[static_cast<std::ranges::range_difference_t<const R>>(row)];
+				}
+		};
+
+		template<typename T> template<typename A> TableColumn<T>::TableColumn(std::string name, A accessor):m_name(std::move(name)) {
+			using V = std::remove_cvref_t<std::invoke_result_t<A, const T&>>;
+			m_value = [accessor](sqlite3_context* ctx, const T& item) { Function::set_result(ctx, std::invoke(accessor, item)); };
+
+			// Comparisons follow SQLite's: numbers numerically and text with the BINARY collation
+			if constexpr (std::is_arithmetic_v<V>) {
+				m_type = std::is_integral_v<V> ? "INTEGER" : "REAL";
+				m_comparable = [](sqlite3_value* value) {
+					const Type type = Function::type(value);
+					return type == Type::Integer || type == Type::Double;
+				};
+				m_compare = [accessor](const T& item, sqlite3_value* value) -> std::weak_ordering {
+					if constexpr (std::is_integral_v<V>) {
+						// Exact for integers, doubles would lose precision above 2^53
+						if (Function::type(value) == Type::Integer)
+							return static_cast<int64_t>(std::invoke(accessor, item)) <=> Function::to_integer(value);
+					}
+					const double key = static_cast<double>(std::invoke(accessor, item)), other = Function::to_double(value);
+					return key < other ? std::weak_ordering::less : key > other ? std::weak_ordering::greater : std::weak_ordering::equivalent;
+				};
+			}
+			else if constexpr (std::is_convertible_v<V, std::string_view>) {
+				m_type = "TEXT";
+				m_comparable = [](sqlite3_value* value) { return Function::is_text(value); };
+				m_compare = [accessor](const T& item, sqlite3_value* value) {
+					const int result = std::string_view(std::invoke(accessor, item)).compare(Function::to_text(value));
+					return result < 0 ? std::weak_ordering::less : result > 0 ? std::weak_ordering::greater : std::weak_ordering::equivalent;
+				};
+			}
+			else {
+				m_comparable = [](sqlite3_value*) { return false; };
+				m_compare = [](const T&, sqlite3_value*) { return std::weak_ordering::equivalent; };
+			}
+		}
+	}
+#endif
@@ -3,6 +3,7 @@
 using namespace StormByte::System;
 
 #ifdef LINUX
+#include <cerrno>
 #include <fcntl.h>
 #include <limits.h>
 #include <signal.h>
@@ -10,6 +11,7 @@ using namespace StormByte::System;
 #else
 SECURITY_ATTRIBUTES Pipe::m_sAttr = { sizeof(SECURITY_ATTRIBUTES), NULL, TRUE };
 #endif
+#include <algorithm>
 #include <vector>
 
 Pipe::Pipe() {
@@ -36,7 +38,11 @@ void Pipe::bind_write(int dest) noexcept {
 }
 
 ssize_t Pipe::write(const std::string& data) {
-	return ::write(m_fd[1], data.c_str(), sizeof(char) * data.length());
+	return write(data.c_str(), data.length());
+}
+
+ssize_t Pipe::write(const char* data, const size_t& length) {
+	return ::write(m_fd[1], data, sizeof(char) * length);
 }
 
 bool Pipe::write_eof() const {
@@ -78,8 +84,12 @@ HANDLE Pipe::get_write_handle() const {
 }
 
 DWORD Pipe::write(const std::string& data) {
+	return write(data.c_str(), data.length());
+}
+
+DWORD Pipe::write(const char* data, const size_t& length) {
 	DWORD dwWritten;
-	WriteFile(m_fd[1], data.c_str(), static_cast<DWORD>(sizeof(char) * data.length()), &dwWritten, NULL);
+	WriteFile(m_fd[1], data, static_cast<DWORD>(sizeof(char) * length), &dwWritten, NULL);
 	return dwWritten;
 }
 
@@ -121,6 +131,33 @@ bool Pipe::write_atomic(std::string&& data) {
 }
 #endif
 
+#ifdef LINUX
+bool Pipe::write_all(const char* data, const size_t& length) {
+	size_t done = 0;
+	while (done < length) {
+		const ssize_t written = ::write(m_fd[1], data + done, length - done);
+		if (written < 0) {
+			if (errno == EINTR)
+				continue;
+			return false;
+		}
+		done += static_cast<size_t>(written);
+	}
+	return true;
+}
+#else
+bool Pipe::write_all(const char* data, const size_t& length) {
+	size_t done = 0;
+	while (done < length) {
+		DWORD dwWritten;
+		if (!WriteFile(m_fd[1], data + done, static_cast<DWORD>(std::min<size_t>(length - done, MAXDWORD)), &dwWritten, NULL))
+			return false;
+		done += dwWritten;
+	}
+	return true;
+}
+#endif
+
 void Pipe::close_read() noexcept {
 	close(m_fd[0]);
 }
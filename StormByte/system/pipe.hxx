@@ -32,6 +32,7 @@ namespace StormByte::System {
 			void bind_write(int) noexcept;
 			void bind_write(Pipe&) noexcept;
 			ssize_t write(const std::string&);
+			ssize_t write(const char*, const size_t&);
 			bool write_eof() const;
 			ssize_t read(std::vector<char>&, ssize_t) const;
 			bool read_eof() const;
@@ -41,9 +42,12 @@ namespace StormByte::System {
 			HANDLE get_read_handle() const;
 			HANDLE get_write_handle() const;
 			DWORD write(const std::string&);
+			DWORD write(const char*, const size_t&);
 			DWORD read(std::vector<CHAR>&, DWORD) const;
 			#endif
 			bool write_atomic(std::string&&);
+			// Blocks while the pipe is full, false once the reading end is gone
+			bool write_all(const char*, const size_t&);
 			void close_read() noexcept;
 			void close_write() noexcept;
 
@@ -42,6 +42,10 @@ Process& Process::operator<<(const std::string& data) {
 	return *this;
 }
 
+bool Process::write(const char* data, const size_t& length) {
+	return m_pstdin.write_all(data, length);
+}
+
 void Process::operator<<(const System::_EoF&) {
 	m_pstdin.close_write();
 }
@@ -39,6 +39,8 @@ namespace StormByte::System {
 			std::string& operator>>(std::string&);
 			friend std::ostream& operator<<(std::ostream&, const Process&);
 			Process& operator<<(const std::string&);
+			// Writes straight from the caller's buffer, blocking while the child is behind; false once it closed its stdin
+			bool write(const char*, const size_t&);
 			void operator<<(const System::_EoF&);
 
 		protected:
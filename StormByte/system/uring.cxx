@@ -0,0 +1,190 @@
+#include <StormByte/system/exception.hxx>
+#include <StormByte/system/uring.hxx>
+
+#ifdef LINUX
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <linux/io_uring.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+using namespace StormByte::System;
+
+namespace {
+	int setup(const unsigned int& entries, io_uring_params& params) noexcept {
+		return static_cast<int>(syscall(__NR_io_uring_setup, entries, &params));
+	}
+
+	int enter(const int& fd, const unsigned int& submit, const unsigned int& wait) noexcept {
+		return static_cast<int>(syscall(__NR_io_uring_enter, fd, submit, wait, wait > 0 ? IORING_ENTER_GETEVENTS : 0, nullptr, 0));
+	}
+
+	unsigned* field(void* ring, const uint32_t& offset) noexcept {
+		return reinterpret_cast<unsigned*>(static_cast<char*>(ring) + offset);
+	}
+}
+
+URing::URing(const unsigned int& entries):m_fd(-1), m_sq_ring(MAP_FAILED), m_cq_ring(MAP_FAILED), m_sq_ring_size(0), m_cq_ring_size(0),
+m_sqes(nullptr), m_sqes_size(0), m_entries(0), m_tail(0), m_broken(false) {
+	io_uring_params params;
+	std::memset(&params, 0, sizeof(params));
+	m_fd = setup(entries, params);
+	if (m_fd < 0)
+		throw Exception(std::string("io_uring is not available: ") + std::strerror(errno));
+
+	m_sq_ring_size = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+	m_cq_ring_size = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+	// Since 5.4 both rings share one mapping
+	const bool single = params.features & IORING_FEAT_SINGLE_MMAP;
+	if (single)
+		m_sq_ring_size = m_cq_ring_size = std::max(m_sq_ring_size, m_cq_ring_size);
+	m_sq_ring = mmap(nullptr, m_sq_ring_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, m_fd, IORING_OFF_SQ_RING);
+	m_cq_ring = single ? m_sq_ring : mmap(nullptr, m_cq_ring_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, m_fd, IORING_OFF_CQ_RING);
+	m_sqes_size = params.sq_entries * sizeof(io_uring_sqe);
+	void* sqes = mmap(nullptr, m_sqes_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, m_fd, IORING_OFF_SQES);
+	if (m_sq_ring == MAP_FAILED || m_cq_ring == MAP_FAILED || sqes == MAP_FAILED) {
+		const std::string error = std::strerror(errno);
+		if (sqes != MAP_FAILED)
+			munmap(sqes, m_sqes_size);
+		release();
+		throw Exception("io_uring rings can not be mapped: " + error);
+	}
+
+	m_sqes = static_cast<io_uring_sqe*>(sqes);
+	m_sq_head = field(m_sq_ring, params.sq_off.head);
+	m_sq_tail = field(m_sq_ring, params.sq_off.tail);
+	m_sq_mask = field(m_sq_ring, params.sq_off.ring_mask);
+	m_sq_array = field(m_sq_ring, params.sq_off.array);
+	m_cq_head = field(m_cq_ring, params.cq_off.head);
+	m_cq_tail = field(m_cq_ring, params.cq_off.tail);
+	m_cq_mask = field(m_cq_ring, params.cq_off.ring_mask);
+	m_cqes = reinterpret_cast<io_uring_cqe*>(static_cast<char*>(m_cq_ring) + params.cq_off.cqes);
+	m_entries = params.sq_entries;
+	m_tail = *m_sq_tail;
+	m_operations.reserve(m_entries);
+}
+
+URing::~URing() noexcept {
+	if (m_sqes)
+		munmap(m_sqes, m_sqes_size);
+	release();
+}
+
+bool URing::Available() noexcept {
+	static const bool available = [] {
+		io_uring_params params;
+		std::memset(&params, 0, sizeof(params));
+		const int fd = setup(2, params);
+		if (fd < 0)
+			return false;
+		close(fd);
+		// Same kernel (5.6) as the plain read/write opcodes used here
+		return (params.features & IORING_FEAT_RW_CUR_POS) != 0;
+	}();
+	return available;
+}
+
+bool URing::Write(const int& fd, const void* data, const size_t& size, const uint64_t& offset) noexcept {
+	io_uring_sqe* sqe = next();
+	if (!sqe)
+		return false;
+	sqe->opcode = IORING_OP_WRITE;
+	sqe->fd = fd;
+	sqe->addr = reinterpret_cast<uint64_t>(data);
+	sqe->len = static_cast<uint32_t>(size);
+	sqe->off = offset;
+	m_operations.push_back({ fd, data, size, offset });
+	return true;
+}
+
+bool URing::Sync(const int& fd, const bool& data_only) noexcept {
+	io_uring_sqe* sqe = next();
+	if (!sqe)
+		return false;
+	sqe->opcode = IORING_OP_FSYNC;
+	sqe->flags = IOSQE_IO_DRAIN;
+	sqe->fd = fd;
+	sqe->fsync_flags = data_only ? IORING_FSYNC_DATASYNC : 0;
+	m_operations.push_back({ fd, nullptr, 0, 0 });
+	return true;
+}
+
+int URing::Submit() noexcept {
+	const unsigned int queued = static_cast<unsigned int>(m_operations.size());
+	if (queued == 0 || m_broken)
+		return 0;
+
+	__atomic_store_n(m_sq_tail, m_tail, __ATOMIC_RELEASE);
+	unsigned int submitted = 0, completed = 0;
+	int result = 0;
+	while (completed < queued) {
+		const int rc = enter(m_fd, queued - submitted, queued - completed);
+		if (rc < 0) {
+			if (errno == EINTR)
+				continue;
+			// Whatever is still queued is abandoned, the caller redoes the batch without the ring
+			m_broken = true;
+			result = -errno;
+			break;
+		}
+		submitted += static_cast<unsigned int>(rc);
+
+		unsigned head = *m_cq_head;
+		const unsigned tail = __atomic_load_n(m_cq_tail, __ATOMIC_ACQUIRE);
+		for (; head != tail; head++, completed++) {
+			const io_uring_cqe& cqe = m_cqes[head & *m_cq_mask];
+			const Operation& operation = m_operations[static_cast<size_t>(cqe.user_data)];
+			if (cqe.res < 0) {
+				if (result == 0)
+					result = cqe.res;
+				continue;
+			}
+			// Finish a short write synchronously
+			size_t done = static_cast<size_t>(cqe.res);
+			while (operation.data && done < operation.size) {
+				const ssize_t written = pwrite(operation.fd, static_cast<const char*>(operation.data) + done, operation.size - done, static_cast<off_t>(operation.offset + done));
+				if (written <= 0) {
+					if (written < 0 && errno == EINTR)
+						continue;
+					if (result == 0)
+						result = written < 0 ? -errno : -EIO;
+					break;
+				}
+				done += static_cast<size_t>(written);
+			}
+		}
+		__atomic_store_n(m_cq_head, head, __ATOMIC_RELEASE);
+	}
+	m_operations.clear();
+	return result;
+}
+
+bool URing::Broken() const noexcept {
+	return m_broken;
+}
+
+io_uring_sqe* URing::next() noexcept {
+	if (m_broken || m_operations.size() >= m_entries)
+		return nullptr;
+	const unsigned index = m_tail & *m_sq_mask;
+	io_uring_sqe* sqe = &m_sqes[index];
+	std::memset(sqe, 0, sizeof(io_uring_sqe));
+	sqe->user_data = m_operations.size();
+	m_sq_array[index] = index;
+	m_tail++;
+	return sqe;
+}
+
+void URing::release() noexcept {
+	if (m_cq_ring != MAP_FAILED && m_cq_ring != m_sq_ring)
+		munmap(m_cq_ring, m_cq_ring_size);
+	if (m_sq_ring != MAP_FAILED)
+		munmap(m_sq_ring, m_sq_ring_size);
+	if (m_fd >= 0)
+		close(m_fd);
+	m_sq_ring = m_cq_ring = MAP_FAILED;
+	m_fd = -1;
+}
+#endif
@@ -0,0 +1,64 @@
+#pragma once
+
+#include <StormByte/visibility.h>
+
+#ifdef LINUX
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+struct io_uring_sqe;
+struct io_uring_cqe;
+namespace StormByte::System {
+	/**
+	 * Minimal io_uring driven through the raw system calls: operations are
+	 * queued and then submitted and waited for together, so a batch of writes
+	 * and the fsync after them cost a single system call. Not thread safe.
+	 */
+	class STORMBYTE_PRIVATE URing {
+		public:
+			URing(const unsigned int&); // Throws Exception when the kernel refuses the ring
+			URing(const URing&)				= delete;
+			URing(URing&&)					= delete;
+			URing& operator=(const URing&)	= delete;
+			URing& operator=(URing&&)		= delete;
+			~URing() noexcept;
+
+			// Whether the kernel supports the operations used here and allows io_uring at all
+			static bool Available() noexcept;
+
+			// False when the ring is full and Submit has to run first
+			bool Write(const int&, const void*, const size_t&, const uint64_t&) noexcept;
+			// Starts once every operation queued before it completed
+			bool Sync(const int&, const bool&) noexcept;
+			// 0 or the first failing operation's negative errno; short writes are finished with pwrite
+			int Submit() noexcept;
+			// The ring itself failed: queued operations never ran and it must not be used again
+			bool Broken() const noexcept;
+
+		private:
+			struct Operation {
+				int fd;
+				const void* data;
+				size_t size;
+				uint64_t offset;
+			};
+
+			int m_fd;
+			void* m_sq_ring;
+			void* m_cq_ring;
+			size_t m_sq_ring_size, m_cq_ring_size;
+			io_uring_sqe* m_sqes;
+			size_t m_sqes_size;
+			unsigned *m_sq_head, *m_sq_tail, *m_sq_mask, *m_sq_array;
+			unsigned *m_cq_head, *m_cq_tail, *m_cq_mask;
+			io_uring_cqe* m_cqes;
+			unsigned m_entries, m_tail;
+			std::vector<Operation> m_operations;
+			bool m_broken;
+
+			io_uring_sqe* next() noexcept;
+			void release() noexcept;
+	};
+}
+#endif
@@ -1,11 +1,103 @@
 #include <StormByte/log/file.hxx>
+#ifdef STORMBYTE_ENABLE_SQLITE
+	#include <StormByte/database/sqlite/exception.hxx>
+	#include <StormByte/database/sqlite/prepared_stmt.hxx>
+	#include <StormByte/database/sqlite/sqlite3.hxx>
+
+	#include <chrono>
+	#include <cstdint>
+	#include <future>
+	#include <iostream>
+	#include <optional>
+	#include <string>
+	#include <vector>
+#endif
 
 using namespace StormByte::Log;
 
+#ifdef STORMBYTE_ENABLE_SQLITE
+using namespace StormByte::Database::SQLite;
+
+class TestDatabase: public SQLite3 {
+	public:
+		TestDatabase():SQLite3(":memory:") { init_database(); }
+		~TestDatabase() noexcept { disable_group_commit(); }
+
+		using SQLite3::cached_query;
+		using SQLite3::enable_group_commit;
+		using SQLite3::enable_query_cache;
+		using SQLite3::group_transaction;
+		using SQLite3::prepare_sentence;
+		using SQLite3::silent_query;
+
+		int64_t scalar(const std::string& name, const std::string& query) {
+			return prepare_sentence(name, query)->Step()->At(0).Value<int64_t>();
+		}
+
+	private:
+		void post_init_action() noexcept override {}
+};
+
+static bool check(const bool& condition, const std::string& name) {
+	if (!condition)
+		std::cerr << "FAILED: " << name << std::endl;
+	return condition;
+}
+
+static bool test_foreign_keys() {
+	TestDatabase db;
+	return check(db.scalar("foreign_keys", "PRAGMA foreign_keys") == 1, "foreign keys are enabled after init_database");
+}
+
+static bool test_group_commit_isolation() {
+	TestDatabase db;
+	db.silent_query("CREATE TABLE units(id INTEGER PRIMARY KEY)");
+	db.silent_query("INSERT INTO units VALUES(2)");
+	db.enable_group_commit(std::chrono::milliseconds(50));
+
+	std::vector<std::future<void>> units;
+	for (int id: { 1, 2, 3 })
+		units.push_back(db.group_transaction([&db, id] {
+			db.silent_query("INSERT INTO units VALUES(" + std::to_string(id) + ")");
+		}));
+
+	bool failed[3] = { false, false, false };
+	for (size_t i = 0; i < units.size(); i++) {
+		try { units[i].get(); }
+		catch (const QueryError&) { failed[i] = true; }
+	}
+	return check(!failed[0] && failed[1] && !failed[2], "only the failing group unit reports an error")
+		&& check(db.scalar("units", "SELECT count(*) FROM units") == 3, "other group units are committed");
+}
+
+static bool test_query_cache_without_rowid() {
+	TestDatabase db;
+	db.silent_query("CREATE TABLE pairs(k TEXT PRIMARY KEY, v) WITHOUT ROWID");
+	auto count = db.prepare_sentence("count", "SELECT count(*) FROM pairs");
+	auto insert = db.prepare_sentence("insert", "INSERT INTO pairs VALUES(?1, 1)");
+	db.enable_query_cache(16, false);
+
+	auto before = db.cached_query(*count);
+	insert->Bind(0, std::optional<std::string>("key"));
+	insert->Execute();
+	insert->Reset();
+	auto after = db.cached_query(*count);
+	return check(before != after, "a WITHOUT ROWID write invalidates cached results")
+		&& check(db.cached_query(*count) == after, "unchanged tables keep serving the cached result");
+}
+#endif
+
 int main() {
 	File f(Level::Info, "/tmp/test.log");
 	f << Level::Debug << "Debug test string" << Logger::endl;
 	f << Level::Info << "Info test string" << Logger::endl;
 	f << Level::Info << "Info test string" << " with more content" << Logger::endl;
+#ifdef STORMBYTE_ENABLE_SQLITE
+	bool ok = test_foreign_keys();
+	ok = test_group_commit_isolation() && ok;
+	ok = test_query_cache_without_rowid() && ok;
+	return ok ? 0 : 1;
+#else
 	return 0;
-}
\ No newline at end of file
+#endif
+}